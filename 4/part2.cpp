@@ -1,37 +1,78 @@
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <cstdint>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <optional>
 #include <sstream>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
-using Seconds = std::chrono::seconds;
+using Minutes = std::chrono::minutes;
 using Minute = uint32_t;
 using Occurrences = uint32_t;
-using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
+using MinuteStamp = int64_t;
 
 using namespace std::chrono_literals;
 using namespace std::string_literals;
 
+constexpr MinuteStamp minutesPerHour = 60;
+constexpr MinuteStamp minutesPerDay = 24 * minutesPerHour;
+
+//Proleptic Gregorian days since 1970-01-01, independent of the local timezone.
+constexpr int64_t DaysFromCivil(int64_t y, unsigned m, unsigned d) {
+	y -= m <= 2;
+	const int64_t era = (y >= 0 ? y : y - 399) / 400;
+	const unsigned yoe = static_cast<unsigned>(y - era * 400);
+	const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+	const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+MinuteStamp ToMinuteStamp(int64_t year, unsigned month, unsigned day, unsigned hour, unsigned minute) {
+	return DaysFromCivil(year, month, day) * minutesPerDay + hour * minutesPerHour + minute;
+}
+
+std::string FormatMinuteStamp(MinuteStamp stamp) {
+	std::time_t t = stamp * 60;
+	std::ostringstream s;
+	s << std::put_time(std::gmtime(&t), "%Y-%m-%d %H:%M");
+	return s.str();
+}
+
 template<typename T>
-uint8_t FindHighestIndex(const std::vector<T>& occurrences) {
-	for (uint8_t i = 0; i < 60; ++i) {
-		bool isGreater = true;
-		for (auto& j : occurrences) {
-			if (occurrences[i] < j) {
-				isGreater = false;
-				break;
-			}
-		}
-		if (isGreater)
-			return i;
+struct HighestIndex {
+	size_t index = 0;
+	T value{};
+	size_t count = 0; //how many indices share value, > 1 means a tie
+};
+
+//Two branch-free reductions over 32-bit values, both of which the compiler vectorises:
+//a max, then a count of the values equal to it folded together with a min over their
+//indices (non-matching indices are forced to all ones). Ties resolve to the lowest index.
+template<typename T>
+HighestIndex<T> FindHighestIndex(const T* values, size_t count) {
+	static_assert(std::is_integral_v<T> && sizeof(T) == 4, "Values must be 32-bit integers");
+	auto size = static_cast<uint32_t>(count);
+	T best = std::numeric_limits<T>::lowest();
+	for (uint32_t i = 0; i < size; ++i)
+		best = std::max(best, values[i]);
+	uint32_t first = std::numeric_limits<uint32_t>::max();
+	uint32_t matches = 0;
+	for (uint32_t i = 0; i < size; ++i) {
+		uint32_t equal = values[i] == best;
+		matches += equal;
+		first = std::min(first, i | (equal - 1));
 	}
-	return 0; //should be unreachable
+	return {matches ? first : 0, best, matches};
 }
 
 enum class ActionType {
@@ -41,19 +82,19 @@ enum class ActionType {
 };
 
 struct DataEntry {
-	TimePoint time;
-	ActionType action;
+	MinuteStamp time = 0;
+	ActionType action = ActionType::start_shift;
 	uint16_t guardID = 0;
-	DataEntry(TimePoint time, ActionType action) : time{time}, action{action} {}
-	DataEntry(TimePoint time, ActionType action, uint16_t guardID) : time{time}, action{action}, guardID{guardID} {}
+	DataEntry() = default;
+	DataEntry(MinuteStamp time, ActionType action) : time{time}, action{action} {}
+	DataEntry(MinuteStamp time, ActionType action, uint16_t guardID) : time{time}, action{action}, guardID{guardID} {}
 	bool operator<(const DataEntry& other) const {
 		return time < other.time;
 	}
 };
 
 std::ostream& operator<<(std::ostream& os, const DataEntry& d) {
-	auto t = std::chrono::system_clock::to_time_t(d.time);
-	os << std::put_time(std::localtime(&t), "%Y-%m-%d %H:%M ");
+	os << FormatMinuteStamp(d.time) << ' ';
 	switch (d.action) {
 		case ActionType::start_shift:
 			os << "- Start Shift" << " - ID: " << d.guardID;
@@ -69,28 +110,84 @@ std::ostream& operator<<(std::ostream& os, const DataEntry& d) {
 }
 
 class SortedDataEntries {
+	static constexpr size_t parallelParseThreshold = 1 << 20;
+	static constexpr unsigned radixBits = 11;
 	std::vector<DataEntry> entries;
-public:
-	SortedDataEntries(std::istream& in) {
-		while (in) {
-			std::tm tm{};
-			in >> std::get_time(&tm, "[%Y-%m-%d %H:%M] ");
-			TimePoint t = std::chrono::system_clock::from_time_t(std::mktime(&tm));
-			std::string action;
-			std::getline(in, action);
-			if (action[0] == 'f') {
-				entries.emplace_back(t, ActionType::fall_asleep);
-			} else if(action[0] == 'w') {
-				entries.emplace_back(t, ActionType::awaken);
-			} else {
-				std::istringstream s{std::move(action)};
-				s.seekg(7, std::ios_base::cur);
-				uint32_t id;
-				s >> id;
-				entries.emplace_back(t, ActionType::start_shift, id);
+	static unsigned ParseDigits(const char* cur, size_t count) {
+		unsigned ret = 0;
+		for (; count; --count, ++cur)
+			ret = ret * 10 + (*cur - '0');
+		return ret;
+	}
+	//Fixed layout: "[YYYY-MM-DD HH:MM] action"
+	static std::vector<DataEntry> ParseChunk(const char* cur, const char* end) {
+		constexpr size_t actionOffset = 19;
+		std::vector<DataEntry> ret;
+		ret.reserve((end - cur) / 28);
+		while (cur < end) {
+			auto eol = std::find(cur, end, '\n');
+			if (eol - cur > static_cast<ptrdiff_t>(actionOffset) && *cur == '[') {
+				auto t = ToMinuteStamp(ParseDigits(cur + 1, 4), ParseDigits(cur + 6, 2), ParseDigits(cur + 9, 2),
+				                       ParseDigits(cur + 12, 2), ParseDigits(cur + 15, 2));
+				auto action = cur + actionOffset;
+				if (*action == 'f') {
+					ret.emplace_back(t, ActionType::fall_asleep);
+				} else if (*action == 'w') {
+					ret.emplace_back(t, ActionType::awaken);
+				} else {
+					auto id = std::find(action, eol, '#') + 1;
+					auto idEnd = std::find(id, eol, ' ');
+					ret.emplace_back(t, ActionType::start_shift, ParseDigits(id, idEnd - id));
+				}
 			}
+			cur = eol + (eol != end);
+		}
+		return ret;
+	}
+	void Parse(const std::string& buffer) {
+		unsigned chunks = buffer.size() < parallelParseThreshold ? 1 : std::max(1u, std::thread::hardware_concurrency());
+		std::vector<std::future<std::vector<DataEntry>>> parts;
+		auto begin = buffer.data();
+		auto end = begin + buffer.size();
+		for (unsigned i = 1; i <= chunks; ++i) {
+			auto split = i == chunks ? end : std::find(buffer.data() + buffer.size() * i / chunks, end, '\n');
+			split += split != end;
+			parts.emplace_back(std::async(chunks == 1 ? std::launch::deferred : std::launch::async, ParseChunk, begin, split));
+			begin = split;
+		}
+		for (auto& part : parts) {
+			auto parsed = part.get();
+			entries.insert(entries.end(), parsed.cbegin(), parsed.cend());
+		}
+	}
+	//Logs span a bounded date range, so a stable LSD radix sort on the minute offset
+	//only needs a couple of passes; already ordered logs skip sorting entirely.
+	void SortByTime() {
+		if (std::is_sorted(entries.cbegin(), entries.cend()))
+			return;
+		auto [lowest, highest] = std::minmax_element(entries.cbegin(), entries.cend());
+		auto base = lowest->time;
+		auto range = static_cast<uint64_t>(highest->time - base);
+		std::vector<DataEntry> scratch(entries.size());
+		std::vector<size_t> offsets(size_t{1} << radixBits);
+		constexpr uint64_t mask = (1 << radixBits) - 1;
+		for (unsigned shift = 0; shift < 64 && (range >> shift) != 0; shift += radixBits) {
+			std::fill(offsets.begin(), offsets.end(), 0);
+			for (const auto& entry : entries)
+				++offsets[(static_cast<uint64_t>(entry.time - base) >> shift) & mask];
+			size_t total = 0;
+			for (auto& offset : offsets)
+				total += std::exchange(offset, total);
+			for (const auto& entry : entries)
+				scratch[offsets[(static_cast<uint64_t>(entry.time - base) >> shift) & mask]++] = entry;
+			entries.swap(scratch);
 		}
-		std::sort(entries.begin(), entries.end());
+	}
+public:
+	SortedDataEntries(std::istream& in) {
+		std::string buffer{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+		Parse(buffer);
+		SortByTime();
 	}
 	const std::vector<DataEntry>& GetEntries() const {
 		return entries;
@@ -98,18 +195,18 @@ public:
 };
 
 class SleepPeriod {
-	TimePoint start;
-	TimePoint end;
+	MinuteStamp start;
+	MinuteStamp end;
 public:
-	SleepPeriod(TimePoint start, TimePoint end) : start{start}, end{end} {}
-	TimePoint Start() const {
+	SleepPeriod(MinuteStamp start, MinuteStamp end) : start{start}, end{end} {}
+	MinuteStamp Start() const {
 		return start;
 	}
-	TimePoint End() const {
+	MinuteStamp End() const {
 		return end;
 	}
-	Seconds Duration() const {
-		return std::chrono::duration_cast<Seconds>(end - start);
+	Minutes Duration() const {
+		return Minutes{end - start};
 	}
 	bool operator>(const SleepPeriod& other) const {
 		return Duration() > other.Duration();
@@ -120,48 +217,24 @@ public:
 };
 
 class Guard {
-	TimePoint shiftStart;
+	MinuteStamp shiftStart;
 	std::vector<SleepPeriod> sleepTimes;
 	uint32_t id;
 public:
-	Guard(TimePoint shiftStart, uint32_t id) : shiftStart{shiftStart}, id{id} {}
+	Guard(MinuteStamp shiftStart, uint32_t id) : shiftStart{shiftStart}, id{id} {}
 	void AddSleepPeriod(SleepPeriod activity) {
 		sleepTimes.emplace_back(std::move(activity));
 	}
-	bool HasLongerSleepTime(const Guard& other) const {
-		auto ourDur = 0s;
-		auto theirDur = 0s;
-		for (const auto& sleep : sleepTimes)
-			ourDur += sleep.Duration();
-		for (const auto& sleep : other.sleepTimes)
-			theirDur += sleep.Duration();
-		return ourDur > theirDur;
-	}
 	const std::vector<SleepPeriod>& GetSleepTimes() const {
 		return sleepTimes;
 	}
 	SleepPeriod GetLongestSleepTime() const {
-		SleepPeriod ret{std::chrono::system_clock::now(), std::chrono::system_clock::now() + 1s};
+		SleepPeriod ret{0, 0};
 		for (const auto& time : sleepTimes)
 			if (time > ret)
 				ret = time;
 		return ret;
 	}
-	std::pair<Minute, Occurrences> GetMinuteMostSpentSleepingInfo() const {
-		auto longestTime = GetLongestSleepTime();
-		std::vector<uint8_t> occurrences(60);
-		for (auto& sleep : sleepTimes) {
-			auto cur = sleep.Start();
-			auto end = sleep.End();
-			for (cur = sleep.Start(); cur < sleep.End(); cur += 1min) {
-				auto tm = std::chrono::system_clock::to_time_t(cur);
-				auto t = std::localtime(&tm);
-				++occurrences[t->tm_min];
-			}
-		}
-		auto idx = FindHighestIndex(occurrences);
-		return {idx, occurrences[idx]};
-	}
 	uint32_t ID() const {
 		return id;
 	}
@@ -169,65 +242,124 @@ public:
 
 std::ostream& operator<<(std::ostream& os, const Guard& guard) {
 	auto longestSleep = guard.GetLongestSleepTime();
-	auto start = std::chrono::system_clock::to_time_t(longestSleep.Start());
-	auto end = std::chrono::system_clock::to_time_t(longestSleep.End());
 	os << "ID: " << std::to_string(guard.ID())
-	   << " Longest Sleep Start: " << std::put_time(std::localtime(&start), "%Y-%m-%d %H:%M")
-	   << " Longest Sleep End: " << std::put_time(std::localtime(&end), "%Y-%m-%d %H:%M") << std::endl;
+	   << " Longest Sleep Start: " << FormatMinuteStamp(longestSleep.Start())
+	   << " Longest Sleep End: " << FormatMinuteStamp(longestSleep.End()) << std::endl;
 	for (const auto& sleep : guard.GetSleepTimes()) {
-		auto start = std::chrono::system_clock::to_time_t(sleep.Start());
-		auto end = std::chrono::system_clock::to_time_t(sleep.End());
-		os << " Sleep Start: " << std::put_time(std::localtime(&start), "%Y-%m-%d %H:%M")
-		   << " Sleep End: " << std::put_time(std::localtime(&end), "%Y-%m-%d %H:%M") << std::endl;
+		os << " Sleep Start: " << FormatMinuteStamp(sleep.Start())
+		   << " Sleep End: " << FormatMinuteStamp(sleep.End()) << std::endl;
 	}
 	return os;
 }
 
+struct GuardSleepInfo {
+	uint32_t id = 0;
+	Minute minute = 0;
+	Occurrences occurrences = 0;
+	Occurrences totalMinutes = 0;
+	uint32_t tiedMinutes = 0;
+};
+
 class GuardShifts {
-	std::unordered_map<uint32_t, Guard> guards;
+	std::vector<Guard> guards;
+	//Dense guards x minutesPerHour matrix, row order matches guards.
+	std::vector<Occurrences> sleepMatrix;
+	std::vector<Occurrences> sleepTotals;
+	const Occurrences* Row(size_t guard) const {
+		return sleepMatrix.data() + guard * minutesPerHour;
+	}
+	GuardSleepInfo GetInfo(size_t guard) const {
+		auto peak = FindHighestIndex(Row(guard), minutesPerHour);
+		return {guards[guard].ID(), static_cast<Minute>(peak.index), peak.value, sleepTotals[guard], static_cast<uint32_t>(peak.count)};
+	}
+	static void AddSleepPeriod(int32_t* deltas, const SleepPeriod& sleep) {
+		//Range-add into a difference row; whole hours hit every bucket equally.
+		auto length = sleep.End() - sleep.Start();
+		auto first = static_cast<int32_t>((sleep.Start() % minutesPerHour + minutesPerHour) % minutesPerHour);
+		auto last = first + static_cast<int32_t>(length % minutesPerHour);
+		auto wholeHours = static_cast<int32_t>(length / minutesPerHour);
+		deltas[0] += wholeHours;
+		deltas[minutesPerHour] -= wholeHours;
+		++deltas[first];
+		if (last <= minutesPerHour) {
+			--deltas[last];
+		} else {
+			--deltas[minutesPerHour];
+			++deltas[0];
+			--deltas[last - minutesPerHour];
+		}
+	}
 public:
 	GuardShifts(const SortedDataEntries& entries) {
+		constexpr size_t deltaWidth = minutesPerHour + 1;
+		std::unordered_map<uint32_t, size_t> guardRows;
+		std::vector<int32_t> deltas;
 		const auto& vec = entries.GetEntries();
 		for (auto entry = vec.cbegin(); entry != vec.cend();) {
 			if (entry->action != ActionType::start_shift)
 				throw std::logic_error{"ABORTING, WRONG ENTRY TYPE"};
-			auto& guard = guards.try_emplace(entry->guardID, entry->time, entry->guardID).first->second;
+			auto [it, inserted] = guardRows.try_emplace(entry->guardID, guards.size());
+			if (inserted) {
+				guards.emplace_back(entry->time, entry->guardID);
+				deltas.resize(deltas.size() + deltaWidth);
+			}
+			auto& guard = guards[it->second];
+			auto row = deltas.data() + it->second * deltaWidth;
 			while (++entry != vec.cend() && entry->action != ActionType::start_shift) {
 				auto sleepStart = entry->time;
 				auto sleepEnd = (++entry)->time;
-				guard.AddSleepPeriod({sleepStart, sleepEnd});
+				SleepPeriod sleep{sleepStart, sleepEnd};
+				AddSleepPeriod(row, sleep);
+				guard.AddSleepPeriod(std::move(sleep));
 			}
 		}
-	}
-	const Guard& FindLaziest() const {
-		static const Guard dummyGuard{std::chrono::system_clock::now(), 0};
-		std::reference_wrapper<const Guard> ret = dummyGuard;
-		for (const auto& pair : guards) {
-			const Guard& guard = pair.second;
-			if (!ret.get().HasLongerSleepTime(guard))
-				ret = guard;
-		}
-		return ret.get();
-	}
-	const Guard& FindGuardWithMostCommonSleepMinute() const {
-		static const Guard dummyGuard{std::chrono::system_clock::now(), 0};
-		std::reference_wrapper<const Guard> ret = dummyGuard;
-		for (const auto& pair : guards) {
-			const Guard& guard = pair.second;
-			auto info = guard.GetMinuteMostSpentSleepingInfo();
-			if (info.second > ret.get().GetMinuteMostSpentSleepingInfo().second)
-				ret = guard;
+		sleepMatrix.resize(guards.size() * minutesPerHour);
+		sleepTotals.resize(guards.size());
+		for (size_t g = 0; g < guards.size(); ++g) {
+			auto row = deltas.data() + g * deltaWidth;
+			auto out = sleepMatrix.data() + g * minutesPerHour;
+			int32_t running = 0;
+			for (size_t i = 0; i < minutesPerHour; ++i) {
+				running += row[i];
+				out[i] = running;
+			}
+			Occurrences total = 0;
+			for (size_t i = 0; i < minutesPerHour; ++i)
+				total += out[i];
+			sleepTotals[g] = total;
 		}
-		return ret.get();
+	}
+	GuardSleepInfo FindLaziest() const {
+		if (guards.empty())
+			return {};
+		return GetInfo(FindHighestIndex(sleepTotals.data(), sleepTotals.size()).index);
+	}
+	GuardSleepInfo FindGuardWithMostCommonSleepMinute() const {
+		auto top = FindMostCommonSleepMinutes(1);
+		return top.empty() ? GuardSleepInfo{} : top.front();
+	}
+	std::vector<GuardSleepInfo> FindMostCommonSleepMinutes(size_t count) const {
+		std::vector<GuardSleepInfo> ret;
+		ret.reserve(guards.size());
+		for (size_t g = 0; g < guards.size(); ++g)
+			ret.emplace_back(GetInfo(g));
+		std::stable_sort(ret.begin(), ret.end(), [](const GuardSleepInfo& a, const GuardSleepInfo& b) {
+			return a.occurrences > b.occurrences;
+		});
+		ret.resize(std::min(count, ret.size()));
+		return ret;
 	}
 };
 
 int main(int argc, char* argv[]) {
-	std::ifstream file{argc == 2 ? argv[1] : "input.txt"};
+	std::ifstream file{argc >= 2 ? argv[1] : "input.txt"};
 	SortedDataEntries entries{file};
 	GuardShifts shifts{entries};
-	auto guard = shifts.FindGuardWithMostCommonSleepMinute();
-	auto info = guard.GetMinuteMostSpentSleepingInfo();
-	auto id = guard.ID();
-	std::cout << "ID: " << id << " Most Common Minute: " << info.first << " Occurrences: " << info.second << " Answer: " << info.first * id << std::endl;
+	auto top = shifts.FindMostCommonSleepMinutes(argc >= 3 ? std::stoul(argv[2]) : 1);
+	for (const auto& info : top) {
+		std::cout << "ID: " << info.id << " Most Common Minute: " << info.minute << " Occurrences: " << info.occurrences << " Answer: " << info.minute * info.id;
+		if (info.tiedMinutes > 1)
+			std::cout << " (tied across " << info.tiedMinutes << " minutes)";
+		std::cout << std::endl;
+	}
 }
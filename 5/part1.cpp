@@ -1,48 +1,239 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
-class PolymerReactor {
-	std::string polymer;
+using namespace std::string_literals;
 
-	bool FindAndRemovePair(const std::string& pair) {
-		bool wasChanged = false;
-		for (auto i = polymer.find(pair); i != polymer.npos; i = polymer.find(pair)) {
-			wasChanged = true;
-			polymer.erase(i, 2);
+//A letter reacts with the same letter of the opposite case.
+struct AsciiCaseRule {
+	static constexpr char Partner(char u) {
+		auto lower = u | 32;
+		return lower >= 'a' && lower <= 'z' ? u ^ 32 : u;
+	}
+};
+
+//Rule::Partner names the unit each unit reacts with (itself if none), baked into a
+//lookup table over the whole unit range at compile time.
+template<typename Unit, typename Rule>
+class ReactionTable {
+	static_assert(std::is_integral_v<Unit> && sizeof(Unit) <= 2, "Units must be 8 or 16 bit integers");
+	using Index = std::make_unsigned_t<Unit>;
+	static constexpr size_t size = size_t{1} << (8 * sizeof(Unit));
+
+	static constexpr std::array<Unit, size> BuildPartners() {
+		std::array<Unit, size> ret{};
+		for (size_t i = 0; i < size; ++i)
+			ret[i] = Rule::Partner(static_cast<Unit>(i));
+		return ret;
+	}
+	static constexpr std::array<Unit, size> partners = BuildPartners();
+public:
+	static bool Reacts(Unit a, Unit b) {
+		return partners[static_cast<Index>(a)] == b && a != b;
+	}
+};
+
+template<typename Unit, typename Rule>
+class BasicPolymerReactor {
+	using Reaction = ReactionTable<Unit, Rule>;
+	static constexpr size_t parallelThreshold = 1 << 22;
+	static constexpr size_t readBlockUnits = 1 << 20;
+	std::vector<Unit> polymer;
+
+	//A fully reacted run of units; concatenating two of them can only react at the seam.
+	struct Segment {
+		Unit* begin;
+		Unit* end;
+	};
+
+	//The front of the range doubles as the output stack, so one pass reacts everything.
+	static Segment ReduceSegment(Unit* begin, Unit* end) {
+		auto top = begin;
+		for (auto cur = begin; cur != end; ++cur) {
+			if (top != begin && Reaction::Reacts(top[-1], *cur))
+				--top;
+			else
+				*top++ = *cur;
 		}
-		return wasChanged;
+		return {begin, top};
 	}
 
-	bool DoIteration() {
-		std::string pair{2, '\0'};
-		bool madeChange = false;
-		for (auto i = 'A'; i <= 'Z'; ++i) {
-			pair[0] = i;
-			pair[1] = i + 32;
-			while(FindAndRemovePair(pair)) { madeChange = true; }
-			pair[0] = i + 32;
-			pair[1] = i;
-			while(FindAndRemovePair(pair)) { madeChange = true; }
+	static Segment MergeSegments(Segment left, Segment right) {
+		while (left.end != left.begin && right.begin != right.end && Reaction::Reacts(left.end[-1], *right.begin)) {
+			--left.end;
+			++right.begin;
 		}
-		return madeChange;
+		auto length = right.end - right.begin;
+		std::memmove(left.end, right.begin, length * sizeof(Unit));
+		return {left.begin, left.end + length};
 	}
 public:
-	PolymerReactor(std::istream& in) {
-		std::getline(in, polymer);
+	//Text polymers are a single line; wider units are read as raw native-endian binary.
+	//Reads land directly in the polymer's storage, reserved up front when the stream is seekable.
+	BasicPolymerReactor(std::istream& in) {
+		auto start = in.tellg();
+		if (start != std::streampos(-1) && in.seekg(0, std::ios_base::end)) {
+			polymer.reserve(static_cast<size_t>(in.tellg() - start) / sizeof(Unit) + 1);
+			in.seekg(start);
+		}
+		in.clear();
+		size_t size = 0;
+		while (in) {
+			polymer.resize(size + std::max(readBlockUnits, polymer.capacity() - size));
+			auto data = polymer.data() + size;
+			in.read(reinterpret_cast<char*>(data), (polymer.size() - size) * sizeof(Unit));
+			auto count = static_cast<size_t>(in.gcount()) / sizeof(Unit);
+			if constexpr (std::is_same_v<Unit, char>) {
+				auto eol = std::find(data, data + count, '\n');
+				size += eol - data;
+				if (eol != data + count)
+					break;
+			} else
+				size += count;
+		}
+		polymer.resize(size);
 	}
 
 	void DoFullReaction() {
-		while (DoIteration() || DoIteration());
+		auto data = polymer.data();
+		auto size = polymer.size();
+		size_t chunks = size < parallelThreshold ? 1 : std::max(1u, std::thread::hardware_concurrency());
+		auto policy = chunks == 1 ? std::launch::deferred : std::launch::async;
+		std::vector<std::future<Segment>> work;
+		for (size_t i = 0; i < chunks; ++i)
+			work.emplace_back(std::async(policy, ReduceSegment, data + size * i / chunks, data + size * (i + 1) / chunks));
+		std::vector<Segment> segments;
+		for (auto& fut : work)
+			segments.emplace_back(fut.get());
+		//Merge neighbouring segments pairwise, one tree level at a time.
+		while (segments.size() > 1) {
+			work.clear();
+			for (size_t i = 0; i + 1 < segments.size(); i += 2)
+				work.emplace_back(std::async(policy, MergeSegments, segments[i], segments[i + 1]));
+			std::vector<Segment> merged;
+			for (auto& fut : work)
+				merged.emplace_back(fut.get());
+			if (segments.size() % 2)
+				merged.emplace_back(segments.back());
+			segments = std::move(merged);
+		}
+		polymer.resize(segments.front().end - data);
 	}
 
-	const std::string& GetPolymer() const {
+	const std::vector<Unit>& GetPolymer() const {
 		return polymer;
 	}
 };
 
+using PolymerReactor = BasicPolymerReactor<char, AsciiCaseRule>;
+
+//Reacts a polymer of unbounded length a chunk at a time, holding only the reduced stack.
+//With a memory limit set, the oldest half of an oversized stack is spilled to a temporary
+//file and read back only if later units react all the way down to it.
+template<typename Unit, typename Rule>
+class BasicStreamingPolymerReactor {
+	using Reaction = ReactionTable<Unit, Rule>;
+	static constexpr size_t chunkSize = 1 << 20;
+	size_t memoryLimit;
+	std::vector<Unit> stack;
+	std::unique_ptr<std::FILE, decltype(&std::fclose)> spill{nullptr, &std::fclose};
+	size_t spilled = 0;
+
+	void Spill() {
+		if (!spill) {
+			spill.reset(std::tmpfile());
+			if (!spill)
+				throw std::runtime_error{"Unable to create polymer spill file"};
+		}
+		auto count = stack.size() / 2;
+		std::fseek(spill.get(), spilled * sizeof(Unit), SEEK_SET);
+		if (std::fwrite(stack.data(), sizeof(Unit), count, spill.get()) != count)
+			throw std::runtime_error{"Unable to write polymer spill file"};
+		spilled += count;
+		stack.erase(stack.begin(), stack.begin() + count);
+	}
+
+	void Unspill() {
+		auto count = std::min(spilled, memoryLimit / 2);
+		spilled -= count;
+		stack.resize(count);
+		std::fseek(spill.get(), spilled * sizeof(Unit), SEEK_SET);
+		if (std::fread(stack.data(), sizeof(Unit), count, spill.get()) != count)
+			throw std::runtime_error{"Unable to read polymer spill file"};
+	}
+
+	void Feed(Unit unit) {
+		if (stack.empty() && spilled)
+			Unspill();
+		if (!stack.empty() && Reaction::Reacts(stack.back(), unit)) {
+			stack.pop_back();
+		} else {
+			stack.push_back(unit);
+			if (memoryLimit && stack.size() >= memoryLimit)
+				Spill();
+		}
+	}
+public:
+	BasicStreamingPolymerReactor(size_t memoryLimit = 0) : memoryLimit{memoryLimit} {}
+
+	void React(std::istream& in) {
+		std::vector<Unit> chunk(chunkSize);
+		auto bytes = reinterpret_cast<char*>(chunk.data());
+		while (in.read(bytes, chunk.size() * sizeof(Unit)) || in.gcount()) {
+			auto end = chunk.data() + in.gcount() / sizeof(Unit);
+			auto eol = end;
+			if constexpr (std::is_same_v<Unit, char>)
+				eol = std::find(chunk.data(), end, '\n');
+			for (auto cur = chunk.data(); cur != eol; ++cur)
+				Feed(*cur);
+			if (eol != end)
+				break;
+		}
+	}
+
+	size_t Size() const {
+		return spilled + stack.size();
+	}
+
+	void Emit(std::ostream& out) const {
+		std::vector<Unit> buffer(chunkSize);
+		for (size_t pos = 0; pos < spilled; pos += buffer.size()) {
+			auto count = std::min(buffer.size(), spilled - pos);
+			std::fseek(spill.get(), pos * sizeof(Unit), SEEK_SET);
+			if (std::fread(buffer.data(), sizeof(Unit), count, spill.get()) != count)
+				throw std::runtime_error{"Unable to read polymer spill file"};
+			out.write(reinterpret_cast<const char*>(buffer.data()), count * sizeof(Unit));
+		}
+		out.write(reinterpret_cast<const char*>(stack.data()), stack.size() * sizeof(Unit));
+	}
+};
+
+using StreamingPolymerReactor = BasicStreamingPolymerReactor<char, AsciiCaseRule>;
+
 int main(int argc, char* argv[]) {
-	std::ifstream file{argc == 2 ? argv[1] : "input.txt"};
+	std::ifstream file{argc >= 2 ? argv[1] : "input.txt"};
+	if (argc >= 3 && argv[2] == "--stream"s) {
+		constexpr size_t streamMemoryLimit = 256 << 20;
+		StreamingPolymerReactor reactor{streamMemoryLimit};
+		reactor.React(file);
+		if (argc >= 4) {
+			std::ofstream out{argv[3]};
+			reactor.Emit(out);
+		}
+		std::cout << reactor.Size() << std::endl;
+		return 0;
+	}
 	PolymerReactor reactor{file};
 	reactor.DoFullReaction();
 	std::cout << reactor.GetPolymer().size() << std::endl;
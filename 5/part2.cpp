@@ -1,53 +1,181 @@
+#include <algorithm>
 #include <array>
-#include <future>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//A letter reacts with the same letter of the opposite case; both cases share a type.
+struct AsciiCaseRule {
+	static constexpr size_t typeCount = 26;
+	static constexpr bool IsLetter(char u) {
+		auto lower = u | 32;
+		return lower >= 'a' && lower <= 'z';
+	}
+	static constexpr char Partner(char u) {
+		return IsLetter(u) ? u ^ 32 : u;
+	}
+	static constexpr size_t Type(char u) {
+		return IsLetter(u) ? (u | 32) - 'a' : typeCount;
+	}
+};
+
+//Rule::Partner names the unit each unit reacts with (itself if none) and Rule::Type the
+//removable type it belongs to (Rule::typeCount if none), baked into lookup tables over the
+//whole unit range at compile time.
+template<typename Unit, typename Rule>
+class ReactionTable {
+	static_assert(std::is_integral_v<Unit> && sizeof(Unit) <= 2, "Units must be 8 or 16 bit integers");
+	using Index = std::make_unsigned_t<Unit>;
+	using TypeIndex = std::conditional_t<Rule::typeCount < 256, uint8_t, uint16_t>;
+	static constexpr size_t size = size_t{1} << (8 * sizeof(Unit));
+
+	static constexpr std::array<Unit, size> BuildPartners() {
+		std::array<Unit, size> ret{};
+		for (size_t i = 0; i < size; ++i)
+			ret[i] = Rule::Partner(static_cast<Unit>(i));
+		return ret;
+	}
+	static constexpr std::array<TypeIndex, size> BuildTypes() {
+		std::array<TypeIndex, size> ret{};
+		for (size_t i = 0; i < size; ++i)
+			ret[i] = static_cast<TypeIndex>(Rule::Type(static_cast<Unit>(i)));
+		return ret;
+	}
+	static constexpr std::array<Unit, size> partners = BuildPartners();
+	static constexpr std::array<TypeIndex, size> types = BuildTypes();
+public:
+	static constexpr size_t typeCount = Rule::typeCount;
+
+	static bool Reacts(Unit a, Unit b) {
+		return partners[static_cast<Index>(a)] == b && a != b;
+	}
+	static size_t Type(Unit u) {
+		return types[static_cast<Index>(u)];
+	}
+};
+
+template<typename Unit, typename Rule>
+class BasicPolymerReactor {
+	using Reaction = ReactionTable<Unit, Rule>;
+	static constexpr size_t parallelThreshold = 1 << 22;
+	static constexpr size_t readBlockUnits = 1 << 20;
+	std::vector<Unit> polymer;
 
-class PolymerReactor {
-	std::string polymer;
+	//A fully reacted run of units; concatenating two of them can only react at the seam.
+	struct Segment {
+		Unit* begin;
+		Unit* end;
+	};
 
-	bool FindAndRemovePair(const std::string& pair) {
-		bool wasChanged = false;
-		for (auto i = polymer.find(pair); i != polymer.npos; i = polymer.find(pair)) {
-			wasChanged = true;
-			polymer.erase(i, 2);
+	//The front of the range doubles as the output stack, so one pass reacts everything.
+	static Segment ReduceSegment(Unit* begin, Unit* end) {
+		auto top = begin;
+		for (auto cur = begin; cur != end; ++cur) {
+			if (top != begin && Reaction::Reacts(top[-1], *cur))
+				--top;
+			else
+				*top++ = *cur;
 		}
-		return wasChanged;
+		return {begin, top};
 	}
 
-	bool DoIteration() {
-		std::string pair{2, '\0'};
-		bool madeChange = false;
-		for (auto i = 'A'; i <= 'Z'; ++i) {
-			pair[0] = i;
-			pair[1] = i + 32;
-			while(FindAndRemovePair(pair)) { madeChange = true; }
-			pair[0] = i + 32;
-			pair[1] = i;
-			while(FindAndRemovePair(pair)) { madeChange = true; }
+	static Segment MergeSegments(Segment left, Segment right) {
+		while (left.end != left.begin && right.begin != right.end && Reaction::Reacts(left.end[-1], *right.begin)) {
+			--left.end;
+			++right.begin;
 		}
-		return madeChange;
+		auto length = right.end - right.begin;
+		std::memmove(left.end, right.begin, length * sizeof(Unit));
+		return {left.begin, left.end + length};
 	}
 public:
-	PolymerReactor(std::istream& in) {
-		std::getline(in, polymer);
+	//Text polymers are a single line; wider units are read as raw native-endian binary.
+	//Reads land directly in the polymer's storage, reserved up front when the stream is seekable.
+	BasicPolymerReactor(std::istream& in) {
+		auto start = in.tellg();
+		if (start != std::streampos(-1) && in.seekg(0, std::ios_base::end)) {
+			polymer.reserve(static_cast<size_t>(in.tellg() - start) / sizeof(Unit) + 1);
+			in.seekg(start);
+		}
+		in.clear();
+		size_t size = 0;
+		while (in) {
+			polymer.resize(size + std::max(readBlockUnits, polymer.capacity() - size));
+			auto data = polymer.data() + size;
+			in.read(reinterpret_cast<char*>(data), (polymer.size() - size) * sizeof(Unit));
+			auto count = static_cast<size_t>(in.gcount()) / sizeof(Unit);
+			if constexpr (std::is_same_v<Unit, char>) {
+				auto eol = std::find(data, data + count, '\n');
+				size += eol - data;
+				if (eol != data + count)
+					break;
+			} else
+				size += count;
+		}
+		polymer.resize(size);
 	}
 
 	void DoFullReaction() {
-		while (DoIteration() || DoIteration());
-	}
-
-	void RemoveAllUnitsOfType(char u) {
-		for (auto i = polymer.find(u); i != polymer.npos; i = polymer.find(u))
-			polymer.erase(i, 1);
-		u += 32;
-		for (auto i = polymer.find(u); i != polymer.npos; i = polymer.find(u))
-			polymer.erase(i, 1);
+		auto data = polymer.data();
+		auto size = polymer.size();
+		size_t chunks = size < parallelThreshold ? 1 : std::max(1u, std::thread::hardware_concurrency());
+		auto policy = chunks == 1 ? std::launch::deferred : std::launch::async;
+		std::vector<std::future<Segment>> work;
+		for (size_t i = 0; i < chunks; ++i)
+			work.emplace_back(std::async(policy, ReduceSegment, data + size * i / chunks, data + size * (i + 1) / chunks));
+		std::vector<Segment> segments;
+		for (auto& fut : work)
+			segments.emplace_back(fut.get());
+		//Merge neighbouring segments pairwise, one tree level at a time.
+		while (segments.size() > 1) {
+			work.clear();
+			for (size_t i = 0; i + 1 < segments.size(); i += 2)
+				work.emplace_back(std::async(policy, MergeSegments, segments[i], segments[i + 1]));
+			std::vector<Segment> merged;
+			for (auto& fut : work)
+				merged.emplace_back(fut.get());
+			if (segments.size() % 2)
+				merged.emplace_back(segments.back());
+			segments = std::move(merged);
+		}
+		polymer.resize(segments.front().end - data);
 	}
 
-	bool operator<(const PolymerReactor& other) const {
-		return polymer.size() < other.polymer.size();
+	//Reacts the polymer once per unit type as if that type was absent, without modifying it.
+	//All variants advance together a block at a time so the polymer is only read from
+	//memory once; each variant keeps its own stack, whose top stays hot in cache.
+	std::array<size_t, Reaction::typeCount> SizesWithoutEachUnitType() const {
+		constexpr size_t blockSize = 4096;
+		std::array<std::unique_ptr<Unit[]>, Reaction::typeCount> stacks;
+		std::array<size_t, Reaction::typeCount> tops{};
+		for (auto& stack : stacks)
+			stack.reset(new Unit[polymer.size()]);
+		for (size_t block = 0; block < polymer.size(); block += blockSize) {
+			auto begin = polymer.data() + block;
+			auto end = begin + std::min(blockSize, polymer.size() - block);
+			for (size_t variant = 0; variant < stacks.size(); ++variant) {
+				auto stack = stacks[variant].get();
+				auto top = tops[variant];
+				for (auto cur = begin; cur != end; ++cur) {
+					if (Reaction::Type(*cur) == variant)
+						continue;
+					if (top && Reaction::Reacts(stack[top - 1], *cur))
+						--top;
+					else
+						stack[top++] = *cur;
+				}
+				tops[variant] = top;
+			}
+		}
+		return tops;
 	}
 
 	size_t Size() const {
@@ -55,34 +183,24 @@ public:
 	}
 };
 
+using PolymerReactor = BasicPolymerReactor<char, AsciiCaseRule>;
+
+//Removing a unit type commutes with reacting, so every variant starts from the reduced polymer.
 class ShortestPolymerFinder {
-	const PolymerReactor reactor;
+	PolymerReactor reactor;
 public:
-	ShortestPolymerFinder(const PolymerReactor& reactor) : reactor{reactor} {}
+	ShortestPolymerFinder(PolymerReactor polymer) : reactor{std::move(polymer)} {
+		reactor.DoFullReaction();
+	}
 
-	PolymerReactor FindShortestPolymer() {
-		auto ret = reactor;
-		std::array<std::future<PolymerReactor>, 26> computations;
-		auto idx = 0;
-		for (auto i = 'A'; i <= 'Z'; ++i) {
-			computations[idx++] = std::async(std::launch::async, [this, i] {
-				auto test = reactor;
-				test.RemoveAllUnitsOfType(i);
-				test.DoFullReaction();
-				return test;
-			});
-		}
-		for (auto& fut : computations) {
-			auto&& test = fut.get();
-			if (test < ret)
-				ret = std::move(test);
-		}
-		return ret;
+	size_t FindShortestPolymer() const {
+		auto sizes = reactor.SizesWithoutEachUnitType();
+		return std::min(reactor.Size(), *std::min_element(sizes.cbegin(), sizes.cend()));
 	}
 };
 
 int main(int argc, char* argv[]) {
 	std::ifstream file{argc == 2 ? argv[1] : "input.txt"};
 	ShortestPolymerFinder finder{PolymerReactor{file}};
-	std::cout << finder.FindShortestPolymer().Size() << std::endl;
+	std::cout << finder.FindShortestPolymer() << std::endl;
 }
@@ -1,10 +1,17 @@
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <fstream>
 #include <iostream>
-#include <optional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+using namespace std::string_literals;
+
 class Coordinate {
 	int x;
 	int y;
@@ -25,7 +32,7 @@ public:
 };
 
 class Point : public Coordinate {
-	uint32_t neighbourCount = 0;
+	uint64_t neighbourCount = 0;
 public:
 	using Coordinate::Coordinate;
 
@@ -34,13 +41,312 @@ public:
 		return *this;
 	}
 
-	uint32_t NeighbourCount() const noexcept {
+	Point& operator+=(uint64_t count) noexcept {
+		neighbourCount += count;
+		return *this;
+	}
+
+	uint64_t NeighbourCount() const noexcept {
 		return neighbourCount;
 	}
 };
 
+//Coordinates held as separate x and y arrays so the brute-force kernels below
+//vectorise across points rather than striding over interleaved fields.
+class PointSet {
+	std::vector<int32_t> xs;
+	std::vector<int32_t> ys;
+public:
+	static constexpr int32_t tied = -2;
+
+	struct Nearest {
+		int64_t distance;
+		int32_t owner; //index of the unique nearest point, otherwise tied
+	};
+
+	void Add(int32_t x, int32_t y) {
+		xs.push_back(x);
+		ys.push_back(y);
+	}
+
+	size_t Size() const noexcept {
+		return xs.size();
+	}
+
+	const std::vector<int32_t>& Xs() const noexcept {
+		return xs;
+	}
+
+	const std::vector<int32_t>& Ys() const noexcept {
+		return ys;
+	}
+
+	//Two branch-free passes the compiler vectorises: a min reduction over the distances, then
+	//reductions over the points at that distance for the lowest index and the x and y range
+	//(non-matching points are masked to neutral values). Coincident points count as one,
+	//owned by the lowest index as in the flood, so only a second position makes a tie.
+	//Distances are 32-bit by default; spans whose distances exceed that need int64_t.
+	template<typename Distance = int32_t>
+	Nearest FindNearest(int32_t x, int32_t y) const noexcept {
+		auto size = static_cast<uint32_t>(xs.size());
+		auto px = xs.data();
+		auto py = ys.data();
+		auto distance = [&](uint32_t i) {
+			return std::abs(static_cast<Distance>(px[i]) - x) + std::abs(static_cast<Distance>(py[i]) - y);
+		};
+		Distance best = std::numeric_limits<Distance>::max();
+		for (uint32_t i = 0; i < size; ++i)
+			best = std::min(best, distance(i));
+		constexpr int32_t high = std::numeric_limits<int32_t>::max();
+		constexpr int32_t low = std::numeric_limits<int32_t>::min();
+		uint32_t first = std::numeric_limits<uint32_t>::max();
+		int32_t minX = high, maxX = low, minY = high, maxY = low;
+		for (uint32_t i = 0; i < size; ++i) {
+			int32_t match = -static_cast<int32_t>(distance(i) == best);
+			first = std::min(first, i | ~static_cast<uint32_t>(match));
+			minX = std::min(minX, (px[i] & match) | (high & ~match));
+			maxX = std::max(maxX, (px[i] & match) | (low & ~match));
+			minY = std::min(minY, (py[i] & match) | (high & ~match));
+			maxY = std::max(maxY, (py[i] & match) | (low & ~match));
+		}
+		bool single = size && minX == maxX && minY == maxY;
+		return {best, single ? static_cast<int32_t>(first) : tied};
+	}
+
+	int64_t DistanceSum(int32_t x, int32_t y) const noexcept {
+		int64_t ret = 0;
+		for (size_t i = 0; i < xs.size(); ++i)
+			ret += std::abs(xs[i] - x) + std::abs(ys[i] - y);
+		return ret;
+	}
+};
+
+template<typename T>
+class Grid {
+	int width;
+	int height;
+	std::vector<T> cells;
+public:
+	Grid(const Coordinate& min, const Coordinate& max, T init = {}) :
+		width{max.X() - min.X() + 1}, height{max.Y() - min.Y() + 1}, cells(static_cast<size_t>(width) * height, init) {}
+	int Width() const noexcept {
+		return width;
+	}
+	int Height() const noexcept {
+		return height;
+	}
+	size_t Size() const noexcept {
+		return cells.size();
+	}
+	T& operator[](size_t idx) noexcept {
+		return cells[idx];
+	}
+	const T& operator[](size_t idx) const noexcept {
+		return cells[idx];
+	}
+	size_t Index(int col, int row) const noexcept {
+		return static_cast<size_t>(row) * width + col;
+	}
+};
+
+//Region areas in the L1 metric without visiting cells. The lines through every point's x
+//and y split the box into rectangles, and inside one rectangle each distance is linear:
+//a point to the left and below is x + y - (px + py) away, and so on for the other three
+//quadrants. Only the best point of each quadrant can win, and the cells where one beats
+//the other three are cut out by an x bound, a y bound and one diagonal, so each rectangle
+//is counted in closed form. Rectangles are swept a row band at a time, keeping each
+//column's best points so the quadrant bests come from prefix and suffix scans.
+//Time is O(P^2) and memory O(P), independent of the coordinate span.
+class SparseVoronoi {
+	static constexpr int32_t none = -1;
+	static constexpr int32_t tied = -2;
+
+	struct Best {
+		int64_t c = 0;
+		int32_t owner = none;
+	};
+
+	//Quadrant classes as distance = sx * x + sy * y + c, with the best point minimising c.
+	enum Quadrant { leftBelow, leftAbove, rightBelow, rightAbove, quadrants };
+	static constexpr int sx[quadrants] = {1, 1, -1, -1};
+	static constexpr int sy[quadrants] = {1, -1, 1, -1};
+
+	std::vector<uint64_t> areas;
+	std::vector<bool> infinite;
+
+	static Best Combine(const Best& a, const Best& b) noexcept {
+		if (b.owner == none || (a.owner != none && a.c < b.c))
+			return a;
+		if (a.owner == none || b.c < a.c)
+			return b;
+		return {a.c, tied};
+	}
+
+	static int64_t FloorHalf(int64_t v) noexcept {
+		return v >= 0 ? v / 2 : -((1 - v) / 2);
+	}
+
+	//Sum of min(a, width) over a = 1..n.
+	static uint64_t ClampedTriangle(int64_t n, uint64_t width) noexcept {
+		if (n <= 0)
+			return 0;
+		uint64_t m = std::min<uint64_t>(n, width);
+		uint64_t ret = m % 2 ? m * ((m + 1) / 2) : (m / 2) * (m + 1);
+		return ret + (static_cast<uint64_t>(n) - m) * width;
+	}
+
+	//Lattice points (u, v) in [u0, u1] x [v0, v1] with u + v <= t.
+	static uint64_t CountDiagonal(int64_t u0, int64_t u1, int64_t v0, int64_t v1, int64_t t) noexcept {
+		uint64_t width = u1 - u0 + 1;
+		return ClampedTriangle(t - u0 + 1 - v0, width) - ClampedTriangle(t - u0 - v1, width);
+	}
+
+	//Cells of [x0, x1] x [y0, y1] where quadrant k is strictly nearer than every other.
+	static uint64_t CountNearest(int64_t x0, int64_t x1, int64_t y0, int64_t y1, const std::array<Best, quadrants>& best, int k) noexcept {
+		bool diagonal = false;
+		int64_t ex = 0, ey = 0, bound = 0;
+		for (int j = 0; j < quadrants; ++j) {
+			if (j == k || best[j].owner == none)
+				continue;
+			//(sx_k - sx_j) x + (sy_k - sy_j) y < c_j - c_k, halved to an inclusive bound
+			int64_t dx = (sx[k] - sx[j]) / 2;
+			int64_t dy = (sy[k] - sy[j]) / 2;
+			auto t = FloorHalf(best[j].c - best[k].c - 1);
+			if (!dy) {
+				if (dx > 0)
+					x1 = std::min(x1, t);
+				else
+					x0 = std::max(x0, -t);
+			} else if (!dx) {
+				if (dy > 0)
+					y1 = std::min(y1, t);
+				else
+					y0 = std::max(y0, -t);
+			} else {
+				diagonal = true;
+				ex = dx;
+				ey = dy;
+				bound = t;
+			}
+		}
+		if (x0 > x1 || y0 > y1)
+			return 0;
+		if (!diagonal)
+			return static_cast<uint64_t>(x1 - x0 + 1) * static_cast<uint64_t>(y1 - y0 + 1);
+		auto u0 = ex > 0 ? x0 : -x1;
+		auto u1 = ex > 0 ? x1 : -x0;
+		auto v0 = ey > 0 ? y0 : -y1;
+		auto v1 = ey > 0 ? y1 : -y0;
+		return CountDiagonal(u0, u1, v0, v1, bound);
+	}
+
+	//Breakpoints so that ranges [b[i], b[i + 1]) start on every point coordinate and the
+	//box border gets ranges of its own.
+	static std::vector<int64_t> Breakpoints(std::vector<int64_t> coords, int64_t first, int64_t last) {
+		coords.push_back(first);
+		coords.push_back(last);
+		coords.push_back(last + 1);
+		std::sort(coords.begin(), coords.end());
+		coords.erase(std::unique(coords.begin(), coords.end()), coords.end());
+		return coords;
+	}
+
+	static size_t RangeOf(const std::vector<int64_t>& breaks, int64_t v) {
+		return std::lower_bound(breaks.cbegin(), breaks.cend(), v) - breaks.cbegin();
+	}
+public:
+	template<typename Points>
+	SparseVoronoi(const Points& points, const Coordinate& min, const Coordinate& max) : areas(points.size()), infinite(points.size()) {
+		std::vector<int64_t> xs, ys;
+		for (const auto& point : points) {
+			xs.push_back(point.X());
+			ys.push_back(point.Y());
+		}
+		auto xBreaks = Breakpoints(xs, min.X(), max.X());
+		auto yBreaks = Breakpoints(ys, min.Y(), max.Y());
+		auto columns = xBreaks.size() - 1;
+		auto bands = yBreaks.size() - 1;
+		//Points grouped by column, ordered by row, with suffix bests for the upper quadrants.
+		std::vector<size_t> order(points.size());
+		std::vector<size_t> column(points.size()), row(points.size());
+		for (size_t i = 0; i < points.size(); ++i) {
+			order[i] = i;
+			column[i] = RangeOf(xBreaks, xs[i]);
+			row[i] = RangeOf(yBreaks, ys[i]);
+		}
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return column[a] != column[b] ? column[a] < column[b] : row[a] != row[b] ? row[a] < row[b] : a < b;
+		});
+		//Later copies of a coordinate own nothing, as in the flood, so only the first is swept.
+		order.erase(std::unique(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return column[a] == column[b] && row[a] == row[b];
+		}), order.end());
+		std::vector<size_t> columnStart(columns + 1);
+		for (auto i : order)
+			++columnStart[column[i] + 1];
+		std::partial_sum(columnStart.cbegin(), columnStart.cend(), columnStart.begin());
+		std::vector<Best> aboveLeft(order.size() + 1), aboveRight(order.size() + 1);
+		for (size_t col = 0; col < columns; ++col)
+			for (auto k = columnStart[col + 1]; k-- > columnStart[col];) {
+				auto i = order[k];
+				auto next = k + 1 < columnStart[col + 1] ? k + 1 : order.size();
+				aboveLeft[k] = Combine(aboveLeft[next], {ys[i] - xs[i], static_cast<int32_t>(i)});
+				aboveRight[k] = Combine(aboveRight[next], {xs[i] + ys[i], static_cast<int32_t>(i)});
+			}
+		std::vector<size_t> abovePos(columnStart.cbegin(), columnStart.cend() - 1);
+		std::vector<Best> belowLeft(columns), belowRight(columns);
+		std::vector<Best> leftBelowPrefix(columns), leftAbovePrefix(columns);
+		std::vector<Best> rightBelowSuffix(columns + 1), rightAboveSuffix(columns + 1);
+		for (size_t band = 0; band < bands; ++band) {
+			for (size_t col = 0; col < columns; ++col) {
+				auto& pos = abovePos[col];
+				for (; pos < columnStart[col + 1] && row[order[pos]] <= band; ++pos) {
+					auto i = order[pos];
+					belowLeft[col] = Combine(belowLeft[col], {-(xs[i] + ys[i]), static_cast<int32_t>(i)});
+					belowRight[col] = Combine(belowRight[col], {xs[i] - ys[i], static_cast<int32_t>(i)});
+				}
+			}
+			Best lb, la;
+			for (size_t col = 0; col < columns; ++col) {
+				lb = leftBelowPrefix[col] = Combine(lb, belowLeft[col]);
+				auto pos = abovePos[col];
+				la = leftAbovePrefix[col] = Combine(la, pos < columnStart[col + 1] ? aboveLeft[pos] : Best{});
+			}
+			for (auto col = columns; col-- > 0;) {
+				auto pos = abovePos[col];
+				rightBelowSuffix[col] = Combine(rightBelowSuffix[col + 1], belowRight[col]);
+				rightAboveSuffix[col] = Combine(rightAboveSuffix[col + 1], pos < columnStart[col + 1] ? aboveRight[pos] : Best{});
+			}
+			auto y0 = yBreaks[band];
+			auto y1 = yBreaks[band + 1] - 1;
+			for (size_t col = 0; col < columns; ++col) {
+				std::array<Best, quadrants> best{leftBelowPrefix[col], leftAbovePrefix[col], rightBelowSuffix[col + 1], rightAboveSuffix[col + 1]};
+				bool border = band == 0 || band == bands - 1 || col == 0 || col == columns - 1;
+				for (int k = 0; k < quadrants; ++k) {
+					if (best[k].owner < 0)
+						continue;
+					auto count = CountNearest(xBreaks[col], xBreaks[col + 1] - 1, y0, y1, best, k);
+					areas[best[k].owner] += count;
+					if (count && border)
+						infinite[best[k].owner] = true;
+				}
+			}
+		}
+	}
+
+	const std::vector<uint64_t>& Areas() const noexcept {
+		return areas;
+	}
+
+	const std::vector<bool>& Infinite() const noexcept {
+		return infinite;
+	}
+};
+
 class PointMap {
-	using OptionalPoint = std::optional<std::reference_wrapper<Point>>;
+	static constexpr int32_t unowned = -1;
+	static constexpr int32_t tied = -2;
+	static constexpr uint64_t denseCellLimit = 1 << 26;
 
 	std::vector<Point> points;
 	const Point min;
@@ -89,60 +395,180 @@ class PointMap {
 		return {x + 1, y + 1};
 	}
 
-	OptionalPoint FindNearestNeighbour(const Coordinate& c) noexcept {
-		auto lastDistance = points.front().Distance(c);
-		OptionalPoint ret;
-		for (auto& point : points) {
-			auto distance = point.Distance(c);
-			if (distance == 0)
-				return std::ref(point);
-			if (distance < lastDistance) {
-				lastDistance = distance;
-				ret = std::ref(point);
-			}
+	//Multi-source BFS from every point. With no obstacles, BFS depth is the Manhattan
+	//distance, and a cell's nearest points are the union of those of its neighbours one
+	//step closer. So a cell is tied as soon as two owners (or a tie) reach it on the same
+	//level, and its owner is final by the time it is dequeued.
+	Grid<int32_t> FloodNearestNeighbours(std::vector<uint64_t>& areas) const {
+		Grid<int32_t> owners{min, max, unowned};
+		Grid<uint32_t> distances{min, max};
+		std::vector<uint32_t> queue;
+		queue.reserve(owners.Size());
+		for (size_t i = 0; i < points.size(); ++i) {
+			auto idx = owners.Index(points[i].X() - min.X(), points[i].Y() - min.Y());
+			if (owners[idx] != unowned)
+				continue;
+			owners[idx] = static_cast<int32_t>(i);
+			queue.push_back(static_cast<uint32_t>(idx));
 		}
-		auto distCnt = 0;
-		for (const auto& point : points)
-			if (point.Distance(c) == lastDistance && ++distCnt == 2)
-				return {};
-		return ret;
+		auto width = owners.Width();
+		auto height = owners.Height();
+		for (size_t head = 0; head < queue.size(); ++head) {
+			auto idx = queue[head];
+			auto owner = owners[idx];
+			auto col = static_cast<int>(idx % width);
+			auto row = static_cast<int>(idx / width);
+			if (owner != tied)
+				++areas[owner];
+			auto nextDistance = distances[idx] + 1;
+			auto visit = [&](size_t next) {
+				auto& nextOwner = owners[next];
+				if (nextOwner == unowned) {
+					nextOwner = owner;
+					distances[next] = nextDistance;
+					queue.push_back(static_cast<uint32_t>(next));
+				} else if (nextOwner != owner && distances[next] == nextDistance) {
+					nextOwner = tied;
+				}
+			};
+			if (col > 0)
+				visit(idx - 1);
+			if (col < width - 1)
+				visit(idx + 1);
+			if (row > 0)
+				visit(idx - width);
+			if (row < height - 1)
+				visit(idx + width);
+		}
+		return owners;
 	}
 
-	void ComputeNearestNeighbours() noexcept {
-		for (auto x = min.X(); x <= max.X(); ++x)
-			for (auto y = min.Y(); y <= max.Y(); ++y) {
-				auto nn = FindNearestNeighbour({x, y});
-				if (nn)
-					++nn->get();
+	//Cross-checks every flooded cell against a brute-force nearest point search.
+	void ValidateOwners(const Grid<int32_t>& owners) const {
+		PointSet set;
+		for (const auto& point : points)
+			set.Add(point.X(), point.Y());
+		for (auto row = 0; row < owners.Height(); ++row)
+			for (auto col = 0; col < owners.Width(); ++col) {
+				auto nearest = set.FindNearest(min.X() + col, min.Y() + row);
+				auto expected = nearest.owner == PointSet::tied ? tied : nearest.owner;
+				if (owners[owners.Index(col, row)] != expected)
+					throw std::logic_error{"Flooded owner differs from brute force at " + std::to_string(min.X() + col) + ", " + std::to_string(min.Y() + row)};
 			}
 	}
 
-	void RemoveInfinitePoints() noexcept {
-		auto i = std::remove_if(points.begin(), points.end(), [this] (const auto& point) {
-			for (auto x = min.X(); x <= max.X(); ++x) {
-				auto nn = FindNearestNeighbour({x, min.Y()});
-				if (nn && point == *nn)
-					return true;
-				nn = FindNearestNeighbour({x, max.Y()});
-				if (nn && point == *nn)
-					return true;
-			}
-			for (auto y = min.Y(); y <= max.Y(); ++y) {
-				auto nn = FindNearestNeighbour({min.X(), y});
-				if (nn && point == *nn)
-					return true;
-				nn = FindNearestNeighbour({max.X(), y});
-				if (nn && point == *nn)
-					return true;
+	//Only regions that own a cell on the border of the box extend past it, so one scan of
+	//the perimeter of the flooded owners classifies every point.
+	std::vector<bool> FindInfinitePoints(const Grid<int32_t>& owners) const {
+		std::vector<bool> infinite(points.size());
+		auto mark = [&](int col, int row) {
+			auto owner = owners[owners.Index(col, row)];
+			if (owner >= 0)
+				infinite[owner] = true;
+		};
+		for (auto col = 0; col < owners.Width(); ++col) {
+			mark(col, 0);
+			mark(col, owners.Height() - 1);
+		}
+		for (auto row = 0; row < owners.Height(); ++row) {
+			mark(0, row);
+			mark(owners.Width() - 1, row);
+		}
+		return infinite;
+	}
+
+	//Cross-checks sparse areas against the flood over the same box. Boxes too large to flood
+	//are checked on a fixed-seed sample of cells instead: a cell's brute-force owner must have
+	//a non-zero area, and must be infinite when the cell lies on the border.
+	void ValidateSparse(const SparseVoronoi& sparse, uint64_t cells) const {
+		if (cells > denseCellLimit) {
+			ValidateSparseSample(sparse);
+			return;
+		}
+		std::vector<uint64_t> areas(points.size());
+		auto infinite = FindInfinitePoints(FloodNearestNeighbours(areas));
+		for (size_t i = 0; i < points.size(); ++i)
+			if (areas[i] != sparse.Areas()[i] || infinite[i] != sparse.Infinite()[i])
+				throw std::logic_error{"Sparse area differs from flood for " + std::to_string(points[i].X()) + ", " + std::to_string(points[i].Y())};
+	}
+
+	void ValidateSparseSample(const SparseVoronoi& sparse) const {
+		constexpr size_t samples = 1 << 16;
+		PointSet set;
+		for (const auto& point : points)
+			set.Add(point.X(), point.Y());
+		std::mt19937_64 rng{0};
+		std::uniform_int_distribution<int> xs{min.X(), max.X()};
+		std::uniform_int_distribution<int> ys{min.Y(), max.Y()};
+		for (size_t i = 0; i < samples; ++i) {
+			auto x = xs(rng);
+			auto y = ys(rng);
+			//Every other sample is pushed onto the border so infinite regions are exercised.
+			if (i % 2) {
+				bool high = rng() % 2;
+				if (i % 4 == 1)
+					x = high ? max.X() : min.X();
+				else
+					y = high ? max.Y() : min.Y();
 			}
-			return false;
+			auto nearest = set.FindNearest<int64_t>(x, y);
+			if (nearest.owner == PointSet::tied)
+				continue;
+			bool border = x == min.X() || x == max.X() || y == min.Y() || y == max.Y();
+			if (!sparse.Areas()[nearest.owner] || (border && !sparse.Infinite()[nearest.owner]))
+				throw std::logic_error{"Sparse areas disagree with brute force at " + std::to_string(x) + ", " + std::to_string(y)};
+		}
+		std::cerr << "Box too large to flood, validated " << samples << " sampled cells\n";
+	}
+
+	//A point repeating an earlier coordinate must end up with no cells and a finite region.
+	void ValidateDuplicates(const std::vector<uint64_t>& areas, const std::vector<bool>& infinite) const {
+		std::vector<size_t> order(points.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			const auto& l = points[a];
+			const auto& r = points[b];
+			return l.X() != r.X() ? l.X() < r.X() : l.Y() != r.Y() ? l.Y() < r.Y() : a < b;
 		});
-		points.erase(i, points.end());
+		for (size_t i = 1; i < order.size(); ++i) {
+			auto copy = order[i];
+			if (!(points[copy] == points[order[i - 1]]))
+				continue;
+			if (areas[copy] || infinite[copy])
+				throw std::logic_error{"Duplicate point owns cells at " + std::to_string(points[copy].X()) + ", " + std::to_string(points[copy].Y())};
+		}
+	}
+
+	void RemoveInfinitePoints(const std::vector<bool>& infinite) {
+		size_t kept = 0;
+		for (size_t i = 0; i < points.size(); ++i)
+			if (!infinite[i])
+				points[kept++] = points[i];
+		points.erase(points.begin() + kept, points.end());
 	}
 public:
-	PointMap(std::istream& in) : points{PopulatePoints(in)}, min{GetMinPoint(points)}, max{GetMaxPoint(points)} {
-		ComputeNearestNeighbours();
-		RemoveInfinitePoints();
+	//Boxes too large to flood, or sparse set, switch to the analytic sweep.
+	PointMap(std::istream& in, bool validate = false, bool sparse = false) : points{PopulatePoints(in)}, min{GetMinPoint(points)}, max{GetMaxPoint(points)} {
+		auto cells = static_cast<uint64_t>(max.X() - min.X() + 1) * static_cast<uint64_t>(max.Y() - min.Y() + 1);
+		std::vector<uint64_t> areas(points.size());
+		std::vector<bool> infinite;
+		if (sparse || cells > denseCellLimit) {
+			SparseVoronoi voronoi{points, min, max};
+			if (validate)
+				ValidateSparse(voronoi, cells);
+			areas = voronoi.Areas();
+			infinite = voronoi.Infinite();
+		} else {
+			auto owners = FloodNearestNeighbours(areas);
+			if (validate)
+				ValidateOwners(owners);
+			infinite = FindInfinitePoints(owners);
+		}
+		if (validate)
+			ValidateDuplicates(areas, infinite);
+		for (size_t i = 0; i < points.size(); ++i)
+			points[i] += areas[i];
+		RemoveInfinitePoints(infinite);
 	}
 
 	const Point& GetPointWithMostNeighbours() const noexcept {
@@ -155,8 +581,14 @@ public:
 };
 
 int main(int argc, char* argv[]) {
-	std::ifstream file{argc == 2 ? argv[1] : "input.txt"};
-	PointMap pointMap{file};
+	std::ifstream file{argc >= 2 ? argv[1] : "input.txt"};
+	bool validate = false;
+	bool sparse = false;
+	for (auto i = 2; i < argc; ++i) {
+		validate |= argv[i] == "--validate"s;
+		sparse |= argv[i] == "--sparse"s;
+	}
+	PointMap pointMap{file, validate, sparse};
 	const auto& p = pointMap.GetPointWithMostNeighbours();
 	std::cout << "X: " << p.X() << " Y: " << p.Y() << " Neighbours: " << p.NeighbourCount() << '\n';
 }
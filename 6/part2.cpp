@@ -2,49 +2,45 @@
 #include <cmath>
 #include <fstream>
 #include <iostream>
-#include <optional>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
-class Coordinate {
-	int x;
-	int y;
+using namespace std::string_literals;
+
+//Coordinates held as separate x and y arrays so the brute-force distance sum below
+//vectorises across points rather than striding over interleaved fields.
+class PointSet {
+	std::vector<int32_t> xs;
+	std::vector<int32_t> ys;
 public:
-	Coordinate(int x, int y) noexcept : x{x}, y{y} {}
-	int X() const noexcept {
-		return x;
-	}
-	int Y() const noexcept {
-		return y;
+	void Add(int32_t x, int32_t y) {
+		xs.push_back(x);
+		ys.push_back(y);
 	}
-	bool operator==(const Coordinate& other) const noexcept {
-		return x == other.x && y == other.y;
-	}
-	int Distance(const Coordinate& other) const noexcept {
-		return std::abs(x - other.x) + std::abs(y - other.y);
+
+	size_t Size() const noexcept {
+		return xs.size();
 	}
-};
 
-class Point : public Coordinate {
-	uint32_t neighbourCount = 0;
-public:
-	using Coordinate::Coordinate;
+	const std::vector<int32_t>& Xs() const noexcept {
+		return xs;
+	}
 
-	Point& operator++() noexcept {
-		++neighbourCount;
-		return *this;
+	const std::vector<int32_t>& Ys() const noexcept {
+		return ys;
 	}
 
-	uint32_t NeighbourCount() const noexcept {
-		return neighbourCount;
+	int64_t DistanceSum(int32_t x, int32_t y) const noexcept {
+		int64_t ret = 0;
+		for (size_t i = 0; i < xs.size(); ++i)
+			ret += std::abs(xs[i] - x) + std::abs(ys[i] - y);
+		return ret;
 	}
 };
 
 class PointMap {
-	using OptionalPoint = std::optional<std::reference_wrapper<Point>>;
-
-	std::vector<Point> points;
-	const Point min;
-	const Point max;
+	PointSet points;
 
 	static decltype(points) PopulatePoints(std::istream& in) {
 		decltype(points) ret;
@@ -56,57 +52,72 @@ class PointMap {
 			in.ignore(1, '\n');
 			if (!in)
 				break;
-			ret.emplace_back(x, y);
+			ret.Add(x, y);
 		}
 		return ret;
 	}
 
-	static Point GetMinPoint(const decltype(points)& points) noexcept {
-		auto x = points.front().X();
-		auto y = points.front().Y();
-		for (const auto& point : points) {
-			auto tmpX = point.X();
-			auto tmpY = point.Y();
-			if (tmpX < x)
-				x = tmpX;
-			if (tmpY < y)
-				y = tmpY;
+	//Distance sums along one axis for every coordinate where they stay under the limit.
+	//The sum is convex, changing by (#coordinates at or before) - (#coordinates after) per
+	//step, and exceeds the limit once more than limit / P past the outermost coordinate.
+	static std::vector<int64_t> AxisDistanceSums(const std::vector<int32_t>& axis, int64_t limit) {
+		std::vector<int64_t> coords{axis.cbegin(), axis.cend()};
+		std::sort(coords.begin(), coords.end());
+		int64_t count = coords.size();
+		auto pad = limit / count + 1;
+		auto first = coords.front() - pad;
+		int64_t sum = 0;
+		for (auto c : coords)
+			sum += c - first;
+		std::vector<int64_t> ret;
+		size_t before = 0;
+		for (auto pos = first; pos <= coords.back() + pad; ++pos) {
+			while (before < coords.size() && coords[before] <= pos)
+				++before;
+			if (sum < limit)
+				ret.push_back(sum);
+			sum += static_cast<int64_t>(before) - (count - static_cast<int64_t>(before));
 		}
-		return {x - 1, y - 1};
+		//Kept sums are a non-increasing run then a non-decreasing one, so flipping the first run
+		//and merging orders them in linear time.
+		auto valley = std::min_element(ret.begin(), ret.end());
+		std::reverse(ret.begin(), valley);
+		std::inplace_merge(ret.begin(), valley, ret.end());
+		return ret;
 	}
 
-	static Point GetMaxPoint(const decltype(points)& points) noexcept {
-		auto x = points.front().X();
-		auto y = points.front().Y();
-		for (const auto& point : points) {
-			auto tmpX = point.X();
-			auto tmpY = point.Y();
-			if (tmpX > x)
-				x = tmpX;
-			if (tmpY > y)
-				y = tmpY;
-		}
-		return {x + 1, y + 1};
+public:
+	PointMap(std::istream& in) : points{PopulatePoints(in)} {
 	}
 
-public:
-	PointMap(std::istream& in) : points{PopulatePoints(in)}, min{GetMinPoint(points)}, max{GetMaxPoint(points)} {
+	//Total Manhattan distance separates into an x sum plus a y sum, so the region is every
+	//pairing of per-axis sums that totals under the limit, counted with two pointers.
+	uint64_t FindRegionWithinSize(int64_t limit) const {
+		if (!points.Size())
+			return 0;
+		auto xSums = AxisDistanceSums(points.Xs(), limit);
+		auto ySums = AxisDistanceSums(points.Ys(), limit);
+		uint64_t ret = 0;
+		auto y = ySums.size();
+		for (auto xSum : xSums) {
+			while (y && xSum + ySums[y - 1] >= limit)
+				--y;
+			ret += y;
+		}
+		return ret;
 	}
 
-	uint32_t FindRegionWithinSize(uint32_t limit) {
-		uint32_t ret = 0;
-		for (auto x = min.X(); x <= max.X(); ++x)
-			for (auto y = min.Y(); y <= max.Y(); ++y) {
-				const Point p{x, y};
-				auto pointDist = 0;
-				for (const auto& point : points) {
-					pointDist += point.Distance(p);
-					if (pointDist > limit)
-						break;
-				}
-				if (pointDist < limit)
-					++ret;
-			}
+	//Brute-force count over every cell that could possibly be within the limit.
+	uint64_t FindRegionWithinSizeBruteForce(int64_t limit) const {
+		if (!points.Size())
+			return 0;
+		auto pad = limit / static_cast<int64_t>(points.Size()) + 1;
+		auto [minX, maxX] = std::minmax_element(points.Xs().cbegin(), points.Xs().cend());
+		auto [minY, maxY] = std::minmax_element(points.Ys().cbegin(), points.Ys().cend());
+		uint64_t ret = 0;
+		for (auto y = *minY - pad; y <= *maxY + pad; ++y)
+			for (auto x = *minX - pad; x <= *maxX + pad; ++x)
+				ret += points.DistanceSum(static_cast<int32_t>(x), static_cast<int32_t>(y)) < limit;
 		return ret;
 	}
 };
@@ -114,5 +125,9 @@ public:
 int main(int argc, char* argv[]) {
 	std::ifstream file{argc >= 2 ? argv[1] : "input.txt"};
 	PointMap pointMap{file};
-	std::cout << pointMap.FindRegionWithinSize(argc == 3 ? std::stoi(argv[2]) : 10000) << '\n';
+	auto limit = argc >= 3 ? std::stoll(argv[2]) : 10000;
+	auto region = pointMap.FindRegionWithinSize(limit);
+	if (argc == 4 && argv[3] == "--validate"s && region != pointMap.FindRegionWithinSizeBruteForce(limit))
+		throw std::logic_error{"Separable region size differs from brute force"};
+	std::cout << region << '\n';
 }
@@ -1,135 +1,177 @@
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <set>
-#include <unordered_set>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
-class Step {
-public:
-	Step(char id) noexcept : id{id} {}
-	
-	const Step& AddParent(const Step& step) const {
-		parents.emplace(step);
-		return *this;
-	}
-
-	const Step& RemoveParent(const Step& step) const {
-		parents.erase(step);
-		return *this;
-	}
-
-	char ID() const noexcept {
-		return id;
-	}
+//Index of the lowest set bit, found with a de Bruijn multiply; bits must be non-zero
+constexpr uint32_t LowestBit(uint64_t bits) noexcept {
+	constexpr uint64_t deBruijn = 0x03f79d71b4cb0a89;
+	constexpr auto table = [] {
+		std::array<uint32_t, 64> ret{};
+		for (uint32_t i = 0; i < 64; ++i)
+			ret[(deBruijn << i) >> 58] = i;
+		return ret;
+	}();
+	return table[((bits & (~bits + 1)) * deBruijn) >> 58];
+}
 
-	bool operator==(const Step& other) const noexcept {
-		return id == other.id;
+//Steps are numbered in ID order, so comparing indices compares IDs. Children are kept as
+//CSR rows and, for graphs small enough, parents are also kept as one bitmask per step
+class StepGraph {
+	std::vector<std::string> ids;
+	std::vector<uint32_t> childOffsets;
+	std::vector<uint32_t> children;
+	std::vector<uint32_t> parentCounts;
+	std::vector<uint64_t> parentMasks;
+
+	uint32_t Intern(std::unordered_map<std::string, uint32_t>& indices, std::string& id) {
+		auto [it, added] = indices.try_emplace(std::move(id), static_cast<uint32_t>(ids.size()));
+		if (added)
+			ids.emplace_back(it->first);
+		return it->second;
 	}
+public:
+	static constexpr size_t maskLimit = 64;
 
-	bool IsMyParent(const Step& other) const noexcept {
-		if (other == *this)
-			return false;
-		if (parents.find(other) != parents.end())
-			return true;
-		for (const auto& dep : parents)
-			if (dep->IsMyParent(other))
-				return true;
-		return false;
-	}
+	struct IndexRange {
+		const uint32_t* first;
+		const uint32_t* last;
 
-	bool operator<(const Step& other) const noexcept {
-		return id < other.id;
-	}
+		const uint32_t* begin() const noexcept {
+			return first;
+		}
 
-	struct StepHash {
-		size_t operator()(const Step& step) const noexcept {
-			return step.id;
+		const uint32_t* end() const noexcept {
+			return last;
 		}
 	};
 
-	struct StepRef {
-		const Step* step;
-	public:
-		StepRef(const Step& step) noexcept : step{std::addressof(step)} {}
-
-		operator const Step&() const noexcept {
-			return *step;
+	StepGraph(std::istream& in) {
+		std::unordered_map<std::string, uint32_t> indices;
+		std::vector<std::pair<uint32_t, uint32_t>> edges;
+		std::string word, parentID, childID;
+		while (in >> word >> parentID >> word >> word >> word >> word >> word >> childID >> word >> word) {
+			auto parent = Intern(indices, parentID);
+			edges.emplace_back(parent, Intern(indices, childID));
 		}
-
-		bool operator==(const StepRef& other) const noexcept {
-			return (*step) == *other.step;
+		indices.clear();
+		std::vector<uint32_t> order(ids.size()), rank(ids.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [this](uint32_t l, uint32_t r) {
+			return ids[l] < ids[r];
+		});
+		std::vector<std::string> sortedIDs(ids.size());
+		for (uint32_t i = 0; i < order.size(); ++i) {
+			rank[order[i]] = i;
+			sortedIDs[i] = std::move(ids[order[i]]);
 		}
-
-		bool operator<(const StepRef& other) const noexcept {
-			return (*step) < *other.step;
+		ids = std::move(sortedIDs);
+		childOffsets.assign(ids.size() + 1, 0);
+		parentCounts.assign(ids.size(), 0);
+		for (auto& [parent, child] : edges) {
+			parent = rank[parent];
+			child = rank[child];
+			++childOffsets[parent + 1];
+			++parentCounts[child];
 		}
-
-		const Step* operator->() const noexcept {
-			return step;
+		std::partial_sum(childOffsets.begin(), childOffsets.end(), childOffsets.begin());
+		children.resize(edges.size());
+		auto fill = childOffsets;
+		for (const auto& [parent, child] : edges)
+			children[fill[parent]++] = child;
+		if (ids.size() <= maskLimit) {
+			parentMasks.assign(ids.size(), 0);
+			for (const auto& [parent, child] : edges)
+				parentMasks[child] |= uint64_t{1} << parent;
 		}
-	};
-private:
-	char id;
-	mutable std::unordered_set<StepRef, StepHash> parents;
+	}
+
+	size_t Size() const noexcept {
+		return ids.size();
+	}
+
+	const std::string& ID(uint32_t step) const noexcept {
+		return ids[step];
+	}
+
+	IndexRange Children(uint32_t step) const noexcept {
+		return {children.data() + childOffsets[step], children.data() + childOffsets[step + 1]};
+	}
+
+	const std::vector<uint32_t>& ParentCounts() const noexcept {
+		return parentCounts;
+	}
+
+	//Only populated when Size() <= maskLimit
+	uint64_t ParentMask(uint32_t step) const noexcept {
+		return parentMasks[step];
+	}
 };
 
 class StepManager {
-	const std::unordered_set<Step, Step::StepHash> stepsUnique;
-	std::vector<Step::StepRef> sortedSteps;
-
-	static auto GetNextAvailableStep(const std::unordered_set<Step::StepRef, Step::StepHash>& scratch) {
-		std::vector<Step::StepRef> candidates;
-		for (const auto& step : scratch) {
-			bool available = true;
-			for (const auto& cmp : scratch) {
-				if (!step->IsMyParent(cmp))
-					continue;
-				available = false;
-				break;
+	const StepGraph graph;
+	std::vector<uint32_t> sortedSteps;
+
+	//A step is available once every parent bit is in the done mask
+	static auto SortStepsMasked(const StepGraph& graph) {
+		decltype(sortedSteps) ret;
+		uint64_t done = 0;
+		uint64_t remaining = graph.Size() == 64 ? ~uint64_t{0} : (uint64_t{1} << graph.Size()) - 1;
+		while (remaining) {
+			uint64_t available = 0;
+			for (auto bits = remaining; bits; bits &= bits - 1) {
+				auto step = LowestBit(bits);
+				if (!(graph.ParentMask(step) & ~done))
+					available |= uint64_t{1} << step;
 			}
-			if (available)
-				candidates.emplace_back(step);
+			if (!available)
+				throw std::logic_error{"Step dependencies contain a cycle"};
+			auto step = LowestBit(available);
+			ret.emplace_back(step);
+			done |= uint64_t{1} << step;
+			remaining &= ~(uint64_t{1} << step);
 		}
-		if (candidates.size() > 1)
-			std::partial_sort(candidates.begin(), candidates.begin() + 1, candidates.end());
-		return candidates;
+		return ret;
 	}
 
-	static auto SortSteps(const decltype(stepsUnique)& stepsUnique) {
-		std::unordered_set<Step::StepRef, Step::StepHash> scratch{stepsUnique.begin(), stepsUnique.end()};
+	//Kahn's algorithm: a step becomes available once its last parent is taken
+	static auto SortSteps(const StepGraph& graph) {
+		if (graph.Size() <= StepGraph::maskLimit)
+			return SortStepsMasked(graph);
+		auto waiting = graph.ParentCounts();
+		std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> available;
+		for (uint32_t step = 0; step < waiting.size(); ++step)
+			if (!waiting[step])
+				available.emplace(step);
 		decltype(sortedSteps) ret;
-		while (scratch.size()) {
-			auto step = GetNextAvailableStep(scratch);
-			if (step.empty())
-				break;
-			ret.emplace_back(std::move(step.front()));
-			scratch.erase(ret.back());
-			for (auto&& step : scratch)
-				step->RemoveParent(ret.back());
+		ret.reserve(graph.Size());
+		while (!available.empty()) {
+			ret.emplace_back(available.top());
+			available.pop();
+			for (auto child : graph.Children(ret.back()))
+				if (!--waiting[child])
+					available.emplace(child);
 		}
+		if (ret.size() != graph.Size())
+			throw std::logic_error{"Step dependencies contain a cycle"};
 		return ret;
 	}
+public:
+	StepManager(std::istream& in) : graph{in}, sortedSteps{SortSteps(graph)} {}
 
-	static auto InitializeSteps(std::istream& in) {
-		std::unordered_set<Step, Step::StepHash> stepsUnique;
-		while (in) {
-			in.seekg(5, std::ios_base::cur);
-			char id = in.get();
-			if (!in)
-				break;
-			auto& step = *stepsUnique.emplace(id).first;
-			in.seekg(30, std::ios_base::cur);
-			id = in.get();
-			auto& child = *stepsUnique.emplace(id).first;
-			child.AddParent(step);
-			in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-		}
-		return stepsUnique;
+	const std::string& ID(uint32_t step) const noexcept {
+		return graph.ID(step);
 	}
-public:
-	StepManager(std::istream& in) : stepsUnique{InitializeSteps(in)}, sortedSteps{SortSteps(stepsUnique)} {}
+
 	const auto& Steps() const noexcept {
 		return sortedSteps;
 	}
@@ -138,8 +180,7 @@ public:
 int main(int argc, char* argv[]) {
 	std::ifstream file{argc == 2 ? argv[1] : "input.txt"};
 	StepManager stepManager{file};
-	for (const auto& step : stepManager.Steps())
-		std::cout << step->ID();
+	for (auto step : stepManager.Steps())
+		std::cout << stepManager.ID(step);
 	std::cout << '\n';
 }
-
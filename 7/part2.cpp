@@ -1,142 +1,365 @@
 #include <algorithm>
-#include <chrono>
+#include <array>
+#include <cstdint>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
-#include <set>
-#include <unordered_set>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
-//Main Challenge settings
-constexpr auto timeOffset = 4;
-constexpr auto workerCount = 5;
-//Test settings
-//constexpr auto timeOffset = 64;
-//constexpr auto workerCount = 2;
+using namespace std::string_literals;
 
-class Step {
+//"letter:N" takes N seconds plus the alphabet position of the ID, which must be a single
+//letter A-Z; "fixed:N" takes N seconds for any ID
+class DurationModel {
 public:
-	Step(char id) noexcept : id{id}, timeRemaining{static_cast<int>(id) - timeOffset} {}
-	
-	const Step& AddParent(const Step& step) const {
-		parents.emplace(step);
-		return *this;
+	enum class Kind { Letter, Fixed };
+
+	DurationModel(Kind kind, uint64_t base) noexcept : kind{kind}, base{base} {}
+
+	static DurationModel Parse(const std::string& spec) {
+		auto split = spec.find(':');
+		auto name = spec.substr(0, split);
+		uint64_t base = split == std::string::npos ? 0 : std::stoull(spec.substr(split + 1));
+		if (name == "letter")
+			return {Kind::Letter, base};
+		if (name == "fixed")
+			return {Kind::Fixed, base};
+		throw std::logic_error{"Unknown duration model: " + spec};
 	}
 
-	const Step& RemoveParent(const Step& step) const {
-		parents.erase(step);
-		return *this;
+	bool Accepts(const std::string& id) const noexcept {
+		return kind == Kind::Fixed || (id.size() == 1 && id.front() >= 'A' && id.front() <= 'Z');
 	}
 
-	char ID() const noexcept {
-		return id;
+	uint64_t operator()(const std::string& id) const noexcept {
+		return kind == Kind::Letter ? base + static_cast<uint64_t>(id.front() - 'A' + 1) : base;
 	}
+private:
+	Kind kind;
+	uint64_t base;
+};
 
-	uint32_t TimeRemaining() const noexcept {
-		return timeRemaining;
+//Index of the lowest set bit, found with a de Bruijn multiply; bits must be non-zero
+constexpr uint32_t LowestBit(uint64_t bits) noexcept {
+	constexpr uint64_t deBruijn = 0x03f79d71b4cb0a89;
+	constexpr auto table = [] {
+		std::array<uint32_t, 64> ret{};
+		for (uint32_t i = 0; i < 64; ++i)
+			ret[(deBruijn << i) >> 58] = i;
+		return ret;
+	}();
+	return table[((bits & (~bits + 1)) * deBruijn) >> 58];
+}
+
+//Steps are numbered in ID order, so comparing indices compares IDs. Children are kept as
+//CSR rows and, for graphs small enough, parents are also kept as one bitmask per step
+class StepGraph {
+	std::vector<std::string> ids;
+	std::vector<uint32_t> childOffsets;
+	std::vector<uint32_t> children;
+	std::vector<uint32_t> parentCounts;
+	std::vector<uint64_t> parentMasks;
+
+	uint32_t Intern(std::unordered_map<std::string, uint32_t>& indices, std::string& id) {
+		auto [it, added] = indices.try_emplace(std::move(id), static_cast<uint32_t>(ids.size()));
+		if (added)
+			ids.emplace_back(it->first);
+		return it->second;
 	}
+public:
+	static constexpr size_t maskLimit = 64;
 
-	void DoTick() const noexcept {
-		--timeRemaining;
+	struct IndexRange {
+		const uint32_t* first;
+		const uint32_t* last;
+
+		const uint32_t* begin() const noexcept {
+			return first;
+		}
+
+		const uint32_t* end() const noexcept {
+			return last;
+		}
+	};
+
+	StepGraph(std::istream& in) {
+		std::unordered_map<std::string, uint32_t> indices;
+		std::vector<std::pair<uint32_t, uint32_t>> edges;
+		std::string word, parentID, childID;
+		while (in >> word >> parentID >> word >> word >> word >> word >> word >> childID >> word >> word) {
+			auto parent = Intern(indices, parentID);
+			edges.emplace_back(parent, Intern(indices, childID));
+		}
+		indices.clear();
+		std::vector<uint32_t> order(ids.size()), rank(ids.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [this](uint32_t l, uint32_t r) {
+			return ids[l] < ids[r];
+		});
+		std::vector<std::string> sortedIDs(ids.size());
+		for (uint32_t i = 0; i < order.size(); ++i) {
+			rank[order[i]] = i;
+			sortedIDs[i] = std::move(ids[order[i]]);
+		}
+		ids = std::move(sortedIDs);
+		childOffsets.assign(ids.size() + 1, 0);
+		parentCounts.assign(ids.size(), 0);
+		for (auto& [parent, child] : edges) {
+			parent = rank[parent];
+			child = rank[child];
+			++childOffsets[parent + 1];
+			++parentCounts[child];
+		}
+		std::partial_sum(childOffsets.begin(), childOffsets.end(), childOffsets.begin());
+		children.resize(edges.size());
+		auto fill = childOffsets;
+		for (const auto& [parent, child] : edges)
+			children[fill[parent]++] = child;
+		if (ids.size() <= maskLimit) {
+			parentMasks.assign(ids.size(), 0);
+			for (const auto& [parent, child] : edges)
+				parentMasks[child] |= uint64_t{1} << parent;
+		}
 	}
 
-	bool operator==(const Step& other) const noexcept {
-		return id == other.id;
+	size_t Size() const noexcept {
+		return ids.size();
 	}
 
-	bool HasParents() const noexcept {
-		return parents.size() > 0;
+	const std::string& ID(uint32_t step) const noexcept {
+		return ids[step];
 	}
 
-	struct StepHash {
-		size_t operator()(const Step& step) const noexcept {
-			return step.id;
-		}
-	};
+	IndexRange Children(uint32_t step) const noexcept {
+		return {children.data() + childOffsets[step], children.data() + childOffsets[step + 1]};
+	}
 
-	struct StepRef {
-		const Step* step;
-	public:
-		StepRef(const Step& step) noexcept : step{std::addressof(step)} {}
+	const std::vector<uint32_t>& ParentCounts() const noexcept {
+		return parentCounts;
+	}
 
-		operator const Step&() const noexcept {
-			return *step;
-		}
+	//Only populated when Size() <= maskLimit
+	uint64_t ParentMask(uint32_t step) const noexcept {
+		return parentMasks[step];
+	}
+};
 
-		bool operator==(const StepRef& other) const noexcept {
-			return (*step) == *other.step;
-		}
+struct StepTiming {
+	uint64_t earliestStart;
+	uint64_t latestStart;
 
-		const Step* operator->() const noexcept {
-			return step;
-		}
-	};
-private:
-	char id;
-	mutable int timeRemaining;
-	mutable std::unordered_set<StepRef, StepHash> parents;
+	uint64_t Slack() const noexcept {
+		return latestStart - earliestStart;
+	}
+};
+
+//Timings are indexed by step; path is one chain of zero-slack steps spanning the whole length
+struct CriticalPathReport {
+	uint64_t length = 0;
+	std::vector<StepTiming> timings;
+	std::vector<uint32_t> path;
 };
 
 class StepManager {
-	const std::unordered_set<Step, Step::StepHash> stepsUnique;
-	int workTotal;
-
-	static auto GetNextAvailableSteps(const std::unordered_set<Step::StepRef, Step::StepHash>& scratch, int limit) {
-		std::vector<Step::StepRef> candidates;
-		for (const auto& step : scratch) {
-			if (!step->HasParents() && limit--)
-				candidates.emplace_back(step);
-			if (!limit)
-				break;
+	const StepGraph graph;
+	const std::vector<uint64_t> durations;
+
+	struct Completion {
+		uint64_t time;
+		uint32_t step;
+
+		bool operator>(const Completion& other) const noexcept {
+			return time != other.time ? time > other.time : step > other.step;
+		}
+	};
+
+	using CompletionQueue = std::priority_queue<Completion, std::vector<Completion>, std::greater<>>;
+
+	//A step is ready once every parent bit is in the done mask and it has not been started
+	uint64_t SimulateMasked(size_t workerCount) const {
+		CompletionQueue running;
+		uint64_t elapsed = 0, done = 0;
+		uint64_t waiting = graph.Size() == 64 ? ~uint64_t{0} : (uint64_t{1} << graph.Size()) - 1;
+		while (waiting || !running.empty()) {
+			uint64_t ready = 0;
+			for (auto bits = waiting; bits; bits &= bits - 1) {
+				auto step = LowestBit(bits);
+				if (!(graph.ParentMask(step) & ~done))
+					ready |= uint64_t{1} << step;
+			}
+			for (; ready && running.size() < workerCount; ready &= ready - 1) {
+				auto step = LowestBit(ready);
+				running.push({elapsed + durations[step], step});
+				waiting &= ~(uint64_t{1} << step);
+			}
+			if (running.empty())
+				throw std::logic_error{"Step dependencies contain a cycle"};
+			elapsed = running.top().time;
+			do {
+				done |= uint64_t{1} << running.top().step;
+				running.pop();
+			} while (!running.empty() && running.top().time == elapsed);
 		}
-		return candidates;
-	}
-
-	static auto CalculateWork(const decltype(stepsUnique)& stepsUnique) {
-		std::unordered_set<Step::StepRef, Step::StepHash> scratch{stepsUnique.begin(), stepsUnique.end()};
-		auto elapsed = 0;
-		while (scratch.size()) {
-			auto steps = GetNextAvailableSteps(scratch, workerCount);
-			for (auto&& step : steps) {
-				step->DoTick();
-				if (step->TimeRemaining() == 0) {
-					for (auto& i : scratch)
-						i->RemoveParent(step);
-					scratch.erase(step);
-				}
+		return elapsed;
+	}
+
+	//Discrete-event simulation: idle workers take the alphabetically first ready step,
+	//then time jumps straight to the earliest completion
+	uint64_t Simulate(size_t workerCount) const {
+		if (!workerCount)
+			throw std::logic_error{"At least one worker is required"};
+		if (graph.Size() <= StepGraph::maskLimit)
+			return SimulateMasked(workerCount);
+		auto waiting = graph.ParentCounts();
+		std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> ready;
+		for (uint32_t step = 0; step < waiting.size(); ++step)
+			if (!waiting[step])
+				ready.emplace(step);
+		CompletionQueue running;
+		uint64_t elapsed = 0;
+		size_t completed = 0;
+		while (!ready.empty() || !running.empty()) {
+			while (!ready.empty() && running.size() < workerCount) {
+				running.push({elapsed + durations[ready.top()], ready.top()});
+				ready.pop();
 			}
-			++elapsed;
+			elapsed = running.top().time;
+			do {
+				for (auto child : graph.Children(running.top().step))
+					if (!--waiting[child])
+						ready.emplace(child);
+				running.pop();
+				++completed;
+			} while (!running.empty() && running.top().time == elapsed);
 		}
+		if (completed != graph.Size())
+			throw std::logic_error{"Step dependencies contain a cycle"};
 		return elapsed;
 	}
 
-	static auto InitializeSteps(std::istream& in) {
-		std::unordered_set<Step, Step::StepHash> stepsUnique;
-		while (in) {
-			in.seekg(5, std::ios_base::cur);
-			char id = in.get();
-			if (!in)
-				break;
-			auto& step = *stepsUnique.emplace(id).first;
-			in.seekg(30, std::ios_base::cur);
-			id = in.get();
-			auto& child = *stepsUnique.emplace(id).first;
-			child.AddParent(step);
-			in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	static auto InitializeDurations(const StepGraph& graph, const DurationModel& model) {
+		std::vector<uint64_t> ret(graph.Size());
+		for (uint32_t step = 0; step < ret.size(); ++step) {
+			if (!model.Accepts(graph.ID(step)))
+				throw std::logic_error{"Letter durations need single A-Z step IDs, got: " + graph.ID(step)};
+			ret[step] = model(graph.ID(step));
 		}
-		return stepsUnique;
+		return ret;
 	}
 public:
-	StepManager(std::istream& in) : stepsUnique{InitializeSteps(in)}, workTotal{CalculateWork(stepsUnique)} {}
+	StepManager(std::istream& in, const DurationModel& model) : graph{in}, durations{InitializeDurations(graph, model)} {}
 
-	uint32_t WorkTotal() const noexcept {
-		return workTotal;
+	uint64_t CalculateWork(size_t workerCount) const {
+		return Simulate(workerCount);
+	}
+
+	//Earliest starts are relaxed forward while Kahn's algorithm produces the topological
+	//order, latest starts are then relaxed back over that order. No worker count can
+	//finish sooner than the length, and only zero-slack steps bound it
+	CriticalPathReport CriticalPath() const {
+		CriticalPathReport ret;
+		ret.timings.assign(graph.Size(), {0, 0});
+		auto waiting = graph.ParentCounts();
+		std::vector<uint32_t> order;
+		order.reserve(graph.Size());
+		for (uint32_t step = 0; step < waiting.size(); ++step)
+			if (!waiting[step])
+				order.emplace_back(step);
+		for (size_t i = 0; i < order.size(); ++i) {
+			auto step = order[i];
+			auto finish = ret.timings[step].earliestStart + durations[step];
+			ret.length = std::max(ret.length, finish);
+			for (auto child : graph.Children(step)) {
+				auto& earliest = ret.timings[child].earliestStart;
+				earliest = std::max(earliest, finish);
+				if (!--waiting[child])
+					order.emplace_back(child);
+			}
+		}
+		if (order.size() != graph.Size())
+			throw std::logic_error{"Step dependencies contain a cycle"};
+		for (auto it = order.rbegin(); it != order.rend(); ++it) {
+			auto latestFinish = ret.length;
+			for (auto child : graph.Children(*it))
+				latestFinish = std::min(latestFinish, ret.timings[child].latestStart);
+			ret.timings[*it].latestStart = latestFinish - durations[*it];
+		}
+		auto onPath = [&](uint32_t step, uint64_t start) {
+			return !ret.timings[step].Slack() && ret.timings[step].earliestStart == start;
+		};
+		for (auto step : order) {
+			if (!onPath(step, 0))
+				continue;
+			ret.path.emplace_back(step);
+			break;
+		}
+		for (bool extended = !ret.path.empty(); extended;) {
+			extended = false;
+			auto finish = ret.timings[ret.path.back()].earliestStart + durations[ret.path.back()];
+			for (auto child : graph.Children(ret.path.back())) {
+				if (!onPath(child, finish))
+					continue;
+				ret.path.emplace_back(child);
+				extended = true;
+				break;
+			}
+		}
+		return ret;
+	}
+
+	const std::string& ID(uint32_t step) const noexcept {
+		return graph.ID(step);
+	}
+
+	//Makespans for every worker count in [first, last], simulated concurrently over the shared graph
+	std::vector<uint64_t> CalculateWork(size_t first, size_t last) const {
+		if (first > last)
+			throw std::logic_error{"Worker range is empty"};
+		std::vector<uint64_t> ret(last - first + 1);
+		size_t chunks = std::min<size_t>(ret.size(), std::max(1u, std::thread::hardware_concurrency()));
+		auto policy = chunks == 1 ? std::launch::deferred : std::launch::async;
+		std::vector<std::future<void>> work;
+		for (size_t i = 0; i < chunks; ++i)
+			work.emplace_back(std::async(policy, [&, i] {
+				for (auto j = i; j < ret.size(); j += chunks)
+					ret[j] = Simulate(first + j);
+			}));
+		for (auto& part : work)
+			part.get();
+		return ret;
 	}
 };
 
 int main(int argc, char* argv[]) {
-	std::ifstream file{argc == 2 ? argv[1] : "input.txt"};
-	StepManager stepManager{file};
-	std::cout << stepManager.WorkTotal() << '\n';
+	std::ifstream file{argc >= 2 ? argv[1] : "input.txt"};
+	StepManager stepManager{file, DurationModel::Parse(argc >= 4 ? argv[3] : "letter:60")};
+	if (argc == 5 && argv[4] == "--critical"s) {
+		auto report = stepManager.CriticalPath();
+		std::cout << "Critical path:";
+		for (auto step : report.path)
+			std::cout << ' ' << stepManager.ID(step);
+		std::cout << " Length: " << report.length << '\n';
+		for (uint32_t step = 0; step < report.timings.size(); ++step) {
+			const auto& timing = report.timings[step];
+			std::cout << "Step: " << stepManager.ID(step) << " Earliest: " << timing.earliestStart << " Latest: " << timing.latestStart << " Slack: " << timing.Slack() << '\n';
+		}
+	}
+	std::string workers = argc >= 3 ? argv[2] : "5";
+	auto split = workers.find('-');
+	if (split == std::string::npos) {
+		std::cout << stepManager.CalculateWork(std::stoull(workers)) << '\n';
+		return 0;
+	}
+	size_t first = std::stoull(workers.substr(0, split)), last = std::stoull(workers.substr(split + 1));
+	auto makespans = stepManager.CalculateWork(first, last);
+	for (size_t i = 0; i < makespans.size(); ++i)
+		std::cout << "Workers: " << first + i << " Time: " << makespans[i] << '\n';
 }
-
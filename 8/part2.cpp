@@ -1,64 +1,181 @@
 #include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <utility>
+#include <numeric>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
-class Metadata {
-	int value;
+using namespace std::string_literals;
+
+//Pulls whitespace separated unsigned integers out of a stream a block at a time
+class NumberReader {
+	static constexpr size_t blockSize = 1 << 16;
+	std::istream& in;
+	std::vector<char> block;
+	const char* cur = nullptr;
+	const char* end = nullptr;
+
+	bool Refill() {
+		in.read(block.data(), block.size());
+		cur = block.data();
+		end = cur + in.gcount();
+		return cur != end;
+	}
 public:
-	Metadata(std::istream& in) {
-		in >> value;
+	NumberReader(std::istream& in) : in{in}, block(blockSize) {}
+
+	bool Next(uint32_t& value) {
+		do {
+			for (; cur != end; ++cur)
+				if (static_cast<unsigned>(*cur - '0') < 10)
+					break;
+		} while (cur == end && Refill());
+		if (cur == end)
+			return false;
+		value = 0;
+		do {
+			for (; cur != end && static_cast<unsigned>(*cur - '0') < 10; ++cur)
+				value = value * 10 + (*cur - '0');
+		} while (cur == end && Refill());
+		return true;
 	}
 
-	int Value() const noexcept {
-		return value;
+	uint32_t Next() {
+		uint32_t ret;
+		if (!Next(ret))
+			throw std::logic_error{"License data ends mid-node"};
+		return ret;
 	}
 };
 
-class Node {
-	std::vector<Node> childNodes;
-	std::vector<Metadata> metadataEntries;
+//Nodes are stored in pre-order. Each node's child indices are a contiguous run in a shared
+//array, all metadata sits in one flat array, and parsing uses an explicit stack so depth is unbounded.
+//Children always finish before their parent's metadata is read, so every value is
+//computed bottom-up from its children's cached values in the same pass
+class LicenseTree {
 public:
-	Node(std::istream& in) {
-		int childNodeCount, metadataCount;
-		in >> childNodeCount;
-		in >> metadataCount;
-		childNodes.reserve(childNodeCount);
-		metadataEntries.reserve(metadataCount);
-		while (childNodeCount--)
-			childNodes.emplace_back(in);
-		while (metadataCount--)
-			metadataEntries.emplace_back(in);
+	struct Node {
+		uint32_t childCount;
+		uint32_t metadataCount;
+		size_t childOffset;
+		uint64_t value;
+	};
+private:
+	std::vector<Node> nodes;
+	std::vector<uint32_t> childIndices;
+	std::vector<uint32_t> metadata;
+
+	uint32_t ReadHeader(NumberReader& reader) {
+		auto childCount = reader.Next();
+		auto metadataCount = reader.Next();
+		nodes.push_back({childCount, metadataCount, childIndices.size(), 0});
+		childIndices.resize(childIndices.size() + childCount);
+		return static_cast<uint32_t>(nodes.size() - 1);
+	}
+public:
+	LicenseTree(std::istream& in) {
+		struct Frame {
+			uint32_t node;
+			uint32_t nextChild;
+		};
+		NumberReader reader{in};
+		std::vector<Frame> stack{{ReadHeader(reader), 0}};
+		while (!stack.empty()) {
+			auto& frame = stack.back();
+			auto& node = nodes[frame.node];
+			if (frame.nextChild < node.childCount) {
+				auto slot = node.childOffset + frame.nextChild++;
+				auto child = ReadHeader(reader);
+				childIndices[slot] = child;
+				stack.push_back({child, 0});
+				continue;
+			}
+			for (auto i = node.metadataCount; i; --i) {
+				auto entry = reader.Next();
+				metadata.emplace_back(entry);
+				if (!node.childCount)
+					node.value += entry;
+				else if (entry != 0 && entry <= node.childCount)
+					node.value += nodes[childIndices[node.childOffset + entry - 1]].value;
+			}
+			stack.pop_back();
+		}
 	}
 
-	int MetadataSum() const noexcept {
-		int ret = 0;
-		for (const auto& metadata : metadataEntries)
-			ret += metadata.Value();
-		for (const auto& child : childNodes)
-			ret += child.MetadataSum();
-		return ret;
+	uint64_t MetadataSum() const noexcept {
+		return std::accumulate(metadata.cbegin(), metadata.cend(), uint64_t{0});
 	}
 
-	int Value() const noexcept {
-		int ret = 0;
-		if (childNodes.size() == 0)
-			for (const auto& metadata : metadataEntries)
-				ret += metadata.Value();
-		else
-			for (const auto& metadata : metadataEntries) {
-				auto val = metadata.Value();
-				if (val == 0 || val > childNodes.size())
-					continue;
-				ret += childNodes[val - 1].Value();
+	uint64_t Value() const noexcept {
+		return nodes.front().value;
+	}
+};
+
+//Computes both answers while the numbers stream in, without building the tree. Open nodes
+//keep their header and their finished children's values on a stack, so memory follows the
+//depth and fan-out of the current path rather than the size of the license
+class StreamingLicenseEvaluator {
+	uint64_t metadataSum = 0;
+	uint64_t value = 0;
+public:
+	StreamingLicenseEvaluator(std::istream& in) {
+		struct Frame {
+			uint32_t childCount;
+			uint32_t metadataCount;
+			uint32_t remainingChildren;
+			size_t valueOffset;
+		};
+		NumberReader reader{in};
+		std::vector<Frame> stack;
+		std::vector<uint64_t> childValues;
+		auto open = [&] {
+			auto childCount = reader.Next();
+			auto metadataCount = reader.Next();
+			stack.push_back({childCount, metadataCount, childCount, childValues.size()});
+		};
+		open();
+		while (!stack.empty()) {
+			auto& frame = stack.back();
+			if (frame.remainingChildren) {
+				--frame.remainingChildren;
+				open();
+				continue;
 			}
-		return ret;
+			uint64_t nodeValue = 0;
+			for (auto i = frame.metadataCount; i; --i) {
+				auto entry = reader.Next();
+				metadataSum += entry;
+				if (!frame.childCount)
+					nodeValue += entry;
+				else if (entry != 0 && entry <= frame.childCount)
+					nodeValue += childValues[frame.valueOffset + entry - 1];
+			}
+			childValues.resize(frame.valueOffset);
+			stack.pop_back();
+			if (stack.empty())
+				value = nodeValue;
+			else
+				childValues.emplace_back(nodeValue);
+		}
+	}
+
+	uint64_t MetadataSum() const noexcept {
+		return metadataSum;
+	}
+
+	uint64_t Value() const noexcept {
+		return value;
 	}
 };
 
 int main(int argc, char* argv[]) {
-	std::ifstream file{argc == 2 ? argv[1] : "input.txt"};
-	Node rootNode{file};
-	std::cout << rootNode.Value() << '\n';
+	std::ifstream file{argc >= 2 ? argv[1] : "input.txt"};
+	if (argc >= 3 && argv[2] == "--stream"s) {
+		StreamingLicenseEvaluator evaluator{file};
+		std::cout << evaluator.Value() << '\n';
+		return 0;
+	}
+	LicenseTree tree{file};
+	std::cout << tree.Value() << '\n';
 }
@@ -1,178 +1,159 @@
-#include <cmath>
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
-#include <list>
+#include <limits>
+#include <memory>
+#include <new>
 #include <string>
 #include <vector>
 
+using namespace std::string_literals;
+
 class Marble {
-	uint32_t id;
+	uint64_t id;
 public:
-	Marble(uint32_t id) noexcept : id{id} {}
+	Marble(uint64_t id) noexcept : id{id} {}
 
-	uint32_t ID() const noexcept {
+	uint64_t ID() const noexcept {
 		return id;
 	}
 };
 
-class MarbleCircle {
-	class CircleIterator {
-		std::list<Marble>& marbles;
-		std::list<Marble>::iterator iter;
-		int index;
-
-		int ComputeIndex(int idx) const noexcept {
-			int size = marbles.size();
-			while (idx < 0)
-				idx += size;
-			return idx % size;
-		}
+//Fixed-size chunks rather than one contiguous block, so a huge circle never needs a single
+//giant allocation, and chunks are left uninitialised so untouched pages cost nothing
+template<typename T>
+class ChunkedArray {
+	static constexpr unsigned chunkBits = 20;
+	static constexpr size_t chunkMask = (size_t{1} << chunkBits) - 1;
+	std::vector<std::unique_ptr<T[]>> chunks;
+public:
+	using value_type = T;
+
+	ChunkedArray(size_t size) : chunks((size + chunkMask) >> chunkBits) {
+		for (auto& chunk : chunks)
+			chunk.reset(new T[size_t{1} << chunkBits]);
+	}
+
+	T& operator[](size_t idx) noexcept {
+		return chunks[idx >> chunkBits][idx & chunkMask];
+	}
+
+	const T& operator[](size_t idx) const noexcept {
+		return chunks[idx >> chunkBits][idx & chunkMask];
+	}
+};
+
+//Links packed into five bytes each, enough to address 2^40 marbles, kept in the same kind of
+//uninitialised fixed-size chunks. Indexing yields a proxy that reads or writes the bytes.
+class PackedLinks {
+	static constexpr unsigned chunkBits = 20;
+	static constexpr size_t chunkMask = (size_t{1} << chunkBits) - 1;
+	static constexpr size_t linkBytes = 5;
+	std::vector<std::unique_ptr<uint8_t[]>> chunks;
+
+	uint8_t* Address(size_t idx) const noexcept {
+		return chunks[idx >> chunkBits].get() + (idx & chunkMask) * linkBytes;
+	}
+
+	static uint64_t Load(const uint8_t* bytes) noexcept {
+		uint64_t ret = 0;
+		for (size_t i = linkBytes; i--;)
+			ret = ret << 8 | bytes[i];
+		return ret;
+	}
+public:
+	using value_type = uint64_t;
+
+	class Reference {
+		uint8_t* bytes;
 	public:
-		CircleIterator(std::list<Marble>& marbles) noexcept : marbles{marbles}, iter{marbles.begin()}, index{0} {}
-		CircleIterator(std::list<Marble>& marbles, int idx) noexcept : marbles{marbles}, iter{marbles.begin()}, index{ComputeIndex(idx)} {
-			auto size = marbles.size();
-			if (idx - (size / 2) > 0) {
-				iter = marbles.end();
-				while (size-- > index)
-				       --iter;
-			} else
-				while (size++ < index)
-					++iter;
-		}
-		CircleIterator(const CircleIterator& other) noexcept : marbles{other.marbles}, iter{other.iter}, index{other.index} {}
-		CircleIterator(CircleIterator&& other) noexcept : marbles{other.marbles}, iter{std::move(other.iter)}, index{other.index} {}
-		CircleIterator& operator++() noexcept {
-			++index;
-			++iter;
-			if (iter == marbles.end()) {
-				iter = marbles.begin();
-				index = 0;
-			}
-			return *this;
-		}
-		CircleIterator& operator--() noexcept {
-			if (--index < 0) {
-				index = marbles.size() - 1;
-				iter = --marbles.end();
-			} else
-				--iter;
-			return *this;
-		}
-		CircleIterator operator+(int offset) const noexcept {
-			CircleIterator ret = *this;
-			ret.index = ComputeIndex(index + offset);
-			if (index < ret.index) {
-				auto tgt = ret.index - index;
-				while (tgt--)
-					++ret.iter;
-			} else if (index > ret.index) {
-				auto tgt = index - ret.index;
-				while (tgt--)
-					--ret.iter;
-			}
-			return ret;
-		}
-		CircleIterator operator-(int offset) const noexcept {
-			return operator+(-offset);
-		}
-		CircleIterator& operator=(int newIndex) noexcept {
-			auto oldIndex = index;
-			index = ComputeIndex(newIndex);
-			if (index == 0)
-				iter = marbles.begin();
-			else if (index == (marbles.size() - 1))
-				iter = --marbles.end();
-			else {
-				if (oldIndex < index)
-					while (oldIndex++ < index)
-						++iter;
-				else if (oldIndex > index)
-					while (oldIndex-- > index)
-						--iter;
-			}
-			return *this;
-		}
-		CircleIterator& operator=(const CircleIterator& rhs) noexcept {
-			index = rhs.index;
-			iter = rhs.iter;
-			return *this;
+		Reference(uint8_t* bytes) noexcept : bytes{bytes} {}
+
+		operator uint64_t() const noexcept {
+			return Load(bytes);
 		}
-		CircleIterator& operator=(CircleIterator&& rhs) noexcept {
-			index = std::move(rhs.index);
-			iter = std::move(rhs.iter);
+
+		Reference& operator=(uint64_t value) noexcept {
+			for (size_t i = 0; i < linkBytes; ++i, value >>= 8)
+				bytes[i] = static_cast<uint8_t>(value);
 			return *this;
 		}
-		Marble& operator*() noexcept {
-			return *iter;
-		}
-		const Marble& operator*() const noexcept {
-			return *iter;
-		}
-		Marble* operator->() noexcept {
-			return &*iter;
-		}
-		const Marble* operator->() const noexcept {
-			return &*iter;
-		}
-		const std::list<Marble>::iterator Iter() const noexcept {
-			return iter;
-		}
-		std::list<Marble>::iterator Iter() noexcept {
-			return iter;
-		}
-		size_t Index() const noexcept {
-			return index;
-		}
-		void NotifyDeleted(const CircleIterator& del) {
-			if (index > del.index)
-				--index;
+
+		Reference& operator=(const Reference& other) noexcept {
+			return *this = static_cast<uint64_t>(other);
 		}
 	};
-	std::list<Marble> marbles{{0}};
-	CircleIterator currentMarble{marbles};
-	uint32_t playId = 0;
-
-	uint32_t DoNormalPlace(const int newId) {
-		switch (marbles.size()) {
-			default:
-				auto pos = currentMarble + 2;
-				auto sav = pos - 1;
-				auto idx = pos.Index();
-				if (idx) {
-					marbles.emplace(pos.Iter(), newId);
-					currentMarble = ++sav;
-				} else {
-					marbles.emplace_back(newId);
-					currentMarble = Last();
-				}
-			break;
-		}
+
+	PackedLinks(size_t size) : chunks((size + chunkMask) >> chunkBits) {
+		for (auto& chunk : chunks)
+			chunk.reset(new uint8_t[(size_t{1} << chunkBits) * linkBytes]);
+	}
+
+	Reference operator[](size_t idx) noexcept {
+		return Address(idx);
+	}
+
+	uint64_t operator[](size_t idx) const noexcept {
+		return Load(Address(idx));
+	}
+};
+
+//Marbles are their own indices: next and prev link the circle in preallocated arrays, so
+//placing, stepping and removing a marble are all O(1) without per-marble allocations
+template<typename Links>
+class BasicMarbleCircle {
+	using Link = typename Links::value_type;
+	Links next;
+	Links prev;
+	uint64_t currentMarble = 0;
+	uint64_t playId = 0;
+
+	void InsertAfter(uint64_t pos, uint64_t marble) noexcept {
+		uint64_t after = next[pos];
+		next[marble] = after;
+		prev[marble] = static_cast<Link>(pos);
+		next[pos] = static_cast<Link>(marble);
+		prev[after] = static_cast<Link>(marble);
+	}
+
+	void Remove(uint64_t marble) noexcept {
+		next[prev[marble]] = next[marble];
+		prev[next[marble]] = prev[marble];
+	}
+
+	uint64_t DoNormalPlace(uint64_t newId) noexcept {
+		InsertAfter(next[currentMarble], newId);
+		currentMarble = newId;
 		return 0;
 	}
 
-	uint32_t DoSpecialPlace(const int newId) {
-		auto pos = currentMarble - 7;
-		auto sav = pos + 1;
-		auto ret = pos->ID() + newId;
-		marbles.erase(pos.Iter());
-		sav.NotifyDeleted(pos);
-		currentMarble = std::move(sav);
-		return ret;
+	uint64_t DoSpecialPlace(uint64_t newId) noexcept {
+		auto pos = currentMarble;
+		for (auto i = 0; i < 7; ++i)
+			pos = prev[pos];
+		currentMarble = next[pos];
+		Remove(pos);
+		return pos + newId;
 	}
 public:
-	CircleIterator CurrentMarble() const noexcept {
+	BasicMarbleCircle(uint64_t lastMarbleValue) : next(lastMarbleValue + 1), prev(lastMarbleValue + 1) {
+		next[0] = 0;
+		prev[0] = 0;
+	}
+
+	Marble CurrentMarble() const noexcept {
 		return currentMarble;
 	}
 
-	CircleIterator First() noexcept {
-		return {marbles, 0};
+	Marble Next(const Marble& marble) const noexcept {
+		return next[marble.ID()];
 	}
 
-	CircleIterator Last() noexcept {
-		return {marbles, static_cast<int>(marbles.size()) - 1};
+	Marble Prev(const Marble& marble) const noexcept {
+		return prev[marble.ID()];
 	}
 
-	uint32_t AddMarble() {
+	uint64_t AddMarble() noexcept {
 		auto newId = ++playId;
 		if (newId % 23)
 			return DoNormalPlace(newId);
@@ -180,38 +161,44 @@ public:
 			return DoSpecialPlace(newId);
 	}
 
-	uint32_t LastID() const noexcept {
+	uint64_t LastID() const noexcept {
 		return playId;
 	}
 };
 
 class Player {
-	uint32_t score = 0;
+	uint64_t score = 0;
 public:
-	void AddPoints(uint32_t score) noexcept {
+	void AddPoints(uint64_t score) noexcept {
 		this->score += score;
 	}
 
-	uint32_t Score() const noexcept {
+	uint64_t Score() const noexcept {
 		return score;
 	}
 };
 
-class GameBoard {
-	MarbleCircle marbleCircle;
+template<typename Links>
+class BasicGameBoard {
+	BasicMarbleCircle<Links> marbleCircle;
+	uint64_t lastMarbleValue;
 public:
-	const Marble& CurrentMarble() const noexcept {
-		return *marbleCircle.CurrentMarble();
+	BasicGameBoard(uint64_t lastMarbleValue) : marbleCircle{lastMarbleValue}, lastMarbleValue{lastMarbleValue} {}
+
+	Marble CurrentMarble() const noexcept {
+		return marbleCircle.CurrentMarble();
 	}
 
-	uint32_t SimulatePlay(int lastMarbleValue, size_t playerCount) {
+	uint64_t SimulatePlay(size_t playerCount) {
 		std::vector<Player> players{playerCount};
+		if (!lastMarbleValue)
+			return 0;
 		while (true) {
 			for (auto& player: players) {
 				player.AddPoints(marbleCircle.AddMarble());
 				if (marbleCircle.LastID() != lastMarbleValue)
 					continue;
-				uint32_t ret = 0;
+				uint64_t ret = 0;
 				for (auto& player : players)
 					ret = std::max(ret, player.Score());
 				return ret;
@@ -220,14 +207,39 @@ public:
 	}
 };
 
+using GameBoard = BasicGameBoard<std::vector<uint64_t>>;
+//32-bit links in chunked storage halve the circle's footprint for runs below 2^32 marbles,
+//and 40-bit packed links cover the rest of the accepted range
+using CompactGameBoard = BasicGameBoard<ChunkedArray<uint32_t>>;
+using PackedGameBoard = BasicGameBoard<PackedLinks>;
+
 int main(int argc, char* argv[]) {
-	if (argc != 3) {
-		std::cerr << "Wrong number of arguments, expect [playerCount] [lastMarbleValue]\n";
+	constexpr uint64_t maxMarbleValue = uint64_t{1} << 40;
+	constexpr uint64_t maxCompactMarbleValue = std::numeric_limits<uint32_t>::max();
+	if (argc != 3 && !(argc == 4 && argv[3] == "--compact"s)) {
+		std::cerr << "Wrong number of arguments, expect [playerCount] [lastMarbleValue] [--compact]\n"
+		          << "lastMarbleValue may be up to 2^40; the circle takes 16 bytes per marble, or 8 (10 above 2^32) with --compact\n";
+		return 0;
+	}
+	size_t playerCount = std::stoull(argv[1]);
+	uint64_t lastMarbleValue = std::stoull(argv[2]);
+	bool compact = argc == 4;
+	if (lastMarbleValue > maxMarbleValue) {
+		std::cerr << "Last marble value must not exceed " << maxMarbleValue << '\n';
 		return 0;
 	}
-	size_t playerCount = std::stoi(argv[1]);
-	size_t lastMarbleValue = std::stoi(argv[2]);
-	GameBoard game;
 	std::cout << playerCount <<" Players, " << "Last Marble: " << lastMarbleValue << std::endl;
-	std::cout << "High Score: " << game.SimulatePlay(lastMarbleValue, playerCount) << std::endl;
+	uint64_t highScore;
+	try {
+		if (!compact)
+			highScore = GameBoard{lastMarbleValue}.SimulatePlay(playerCount);
+		else if (lastMarbleValue <= maxCompactMarbleValue)
+			highScore = CompactGameBoard{lastMarbleValue}.SimulatePlay(playerCount);
+		else
+			highScore = PackedGameBoard{lastMarbleValue}.SimulatePlay(playerCount);
+	} catch (const std::bad_alloc&) {
+		std::cerr << "Not enough memory for a circle of " << lastMarbleValue << " marbles" << (compact ? "" : ", try --compact") << '\n';
+		return 1;
+	}
+	std::cout << "High Score: " << highScore << std::endl;
 }